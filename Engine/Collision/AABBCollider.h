@@ -7,7 +7,7 @@
 
 #include "Collider.h"
 
-class AABBCollider : public Collider {
+class AABBCollider final : public Collider {
     static Mesh* renderMesh;
     BoundingBox boundingBox;
 public:
@@ -15,7 +15,13 @@ public:
     AABBCollider(CollisionMode collisionMode, const BoundingBox& boundingBox);
     AABBCollider(CollisionMode collisionMode, glm::vec3 min, glm::vec3 max);
 
-    BoundingBox getBoundingBox() override;
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Get the box of the collider, relative to the collider's position
+     * @return The box of the collider
+     */
+    [[nodiscard]] const BoundingBox& getBox() const;
 
     [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
 
@@ -0,0 +1,62 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "Collider.h"
+
+/**
+ * A capsule in world space, every point within radius of the segment from start to end
+ */
+struct Capsule {
+    glm::vec3 start;
+    glm::vec3 end;
+    float radius;
+
+    /**
+     * Find the point of the capsule furthest in the given direction
+     * @param direction The direction to search in
+     * @return The point, in world space
+     */
+    [[nodiscard]] glm::vec3 getFurthestPoint(glm::vec3 direction) const;
+};
+
+/**
+ * A capsule collider, standing upright along the collider's y axis and rotating with its actor
+ * The capsule is a segment and a radius, so its support point and its collision tests against spheres, boxes and other
+ * capsules are all found directly, without searching a mesh. Like SphereCollider, it isn't scaled by its actor.
+ */
+class CapsuleCollider final : public Collider {
+    static Mesh* renderMesh;
+    float radius;
+    /** Half the length of the segment, the distance from the centre to the centre of each end */
+    float halfHeight;
+public:
+
+    CapsuleCollider(CollisionMode collisionMode, float radius, float halfHeight);
+
+    /**
+     * Get the bounding box of the capsule as it is rotated, relative to the collider's position
+     * @inherit
+     */
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    [[nodiscard]] float getRadius() const;
+
+    [[nodiscard]] float getHalfHeight() const;
+
+    /**
+     * Get the capsule of the collider in world space, with the collider's position and rotation applied
+     * @return The capsule
+     */
+    [[nodiscard]] Capsule getWorldCapsule() const;
+
+    [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
+
+    Mesh* getRenderMesh() override;
+
+    glm::mat4 getRenderMeshTransform() override;
+};
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 #include <Engine/BoundingBox.h>
@@ -16,13 +17,63 @@ enum class CollisionMode {
     NONE
 };
 
+/**
+ * The shape of a collider, used to pick the collision test for a pair of colliders
+ */
+enum class ColliderType {
+    AABB,
+    SPHERE,
+    MESH,
+    OBB,
+    CAPSULE,
+    /** A CompoundCollider, its children are tested instead of it */
+    COMPOUND,
+    /** A TriangleMeshCollider, the triangles near the other collider are tested instead of it */
+    TRIANGLE_MESH,
+    /** A HeightfieldCollider, the triangles of the cells under the other collider are tested instead of it */
+    HEIGHTFIELD,
+    /** A collider that isn't one of the built-in types, it is only tested through its virtual functions */
+    CUSTOM
+};
+
+/** The number of values in ColliderType */
+constexpr size_t COLLIDER_TYPE_COUNT = 9;
+
+/**
+ * The layers a collider is on, and the layers it can collide with
+ * Pairs of colliders are only found if each is on a layer the other collides with, so they never reach the narrow phase
+ */
+struct CollisionFilter {
+    /** The layers the collider is on, one bit for each layer */
+    uint32_t layers = 1;
+    /** The layers the collider can collide with */
+    uint32_t mask = ~0u;
+
+    /**
+     * Check if a pair of colliders with these filters can collide
+     * @param other The filter of the other collider
+     * @return true if each is on a layer the other can collide with
+     */
+    [[nodiscard]] bool canCollideWith(const CollisionFilter& other) const {
+        return (layers & other.mask) != 0 && (other.layers & mask) != 0;
+    }
+};
+
 struct Collider : public LObject {
     bool isColliding = false;
     CollisionMode collisionMode;
+    /** Which other colliders this can collide with */
+    CollisionFilter collisionFilter;
+    /** The shape of the collider, this never changes */
+    const ColliderType colliderType;
+    /** A unique id for the collider, so pairs of colliders can be recognised between frames */
+    const uint32_t id;
+
+    explicit Collider(CollisionMode collisionMode, ColliderType colliderType = ColliderType::CUSTOM);
 
-    explicit Collider(CollisionMode collisionMode);
+    virtual ~Collider() = default;
 
-    virtual BoundingBox getBoundingBox() = 0;
+    [[nodiscard]] virtual BoundingBox getBoundingBox() const = 0;
     virtual Mesh* getRenderMesh() = 0;
 
     virtual glm::mat4 getRenderMeshTransform() = 0;
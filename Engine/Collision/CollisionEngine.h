@@ -4,8 +4,12 @@
 
 #pragma once
 #include <Scene/Actor/Actor.h>
+#include <Utils/ThreadPool.h>
+#include "Triangle.h"
 
 #include <vector>
+#include <utility>
+#include <array>
 
 // We can't include the scene.h lest we want a circular dependency, forward decl instead
 struct Scene;
@@ -22,13 +26,180 @@ struct CollisionResult {
     glm::vec3 normal;
 };
 
+/**
+ * Distance information generated by the collision engine
+ */
+struct DistanceResult {
+    /** Whether the colliders overlap, if they do the distance and closest points aren't set */
+    bool intersecting;
+    /** The distance between the closest points of the colliders */
+    float distance;
+    /** The point on the first collider closest to the second collider, in world space */
+    glm::vec3 closestPoint1;
+    /** The point on the second collider closest to the first collider, in world space */
+    glm::vec3 closestPoint2;
+};
+
+/**
+ * Statistics about the most recent broad phase
+ */
+struct BroadPhaseStats {
+    /** The number of pairs the broad phase considered */
+    size_t candidatePairs = 0;
+    /** The number of those pairs rejected because their bounding boxes didn't overlap */
+    size_t rejectedPairs = 0;
+    /** The number of overlapping pairs skipped because both actors were asleep */
+    size_t sleepingPairs = 0;
+    /** The number of times the broad phase allocated memory since the pairs were last found */
+    size_t allocations = 0;
+
+    /**
+     * Get the fraction of the considered pairs that were rejected
+     * @return The rejection rate, between 0 and 1
+     */
+    [[nodiscard]] float getRejectionRate() const {
+        return candidatePairs == 0 ? 0.f : static_cast<float>(rejectedPairs) / static_cast<float>(candidatePairs);
+    }
+};
+
+/**
+ * A collision test between two colliders of specific types
+ * @param collider1 The collider the collision test is for
+ * @param collider2 The collider the collision test is against
+ * @return The information about the two colliders collision
+ */
+using PairTest = CollisionResult (*)(const Collider* collider1, const Collider* collider2);
+
+/**
+ * A collision test between triangles and a collider of a specific type
+ * The triangles are tested together, so the collider only needs putting in world space once
+ * @param triangles The triangles the collision test is for
+ * @param triangleCount The number of triangles
+ * @param collider The collider the collision test is against
+ * @return The deepest of the triangles' collisions with the collider
+ */
+using TriangleTest = CollisionResult (*)(const Triangle* triangles, size_t triangleCount, const Collider* collider);
+
 /**
  * Interface for Narrow phase collision detection
+ * Pairs of colliders with a registered pair test use it, every other pair uses testGenericCollision. Compound colliders
+ * are split into their children first, and triangle meshes and heightfields into the triangles near the other collider,
+ * which are tested with the registered triangle test for the other collider's type or testGenericTriangle.
  */
 class CollisionEngine {
+    struct PairTestEntry {
+        PairTest test = nullptr;
+        /** The test takes the colliders the other way round, so they are swapped and the normal flipped */
+        bool swapped = false;
+    };
+
+    /** The number of pairs each thread takes at a time in testCollisions, small as the cost of a pair varies a lot */
+    size_t PAIRS_PER_CHUNK = 16;
+
+    /** The pair test for each pair of collider types, indexed by the types of the first and second collider */
+    std::array<std::array<PairTestEntry, COLLIDER_TYPE_COUNT>, COLLIDER_TYPE_COUNT> pairTests;
+
+    /** The triangle test for each collider type, indexed by the type of the collider the triangle is tested against */
+    std::array<TriangleTest, COLLIDER_TYPE_COUNT> triangleTests{};
+
+    /** The broad phase's allocation count when the pairs were last found */
+    size_t lastBroadPhaseAllocations = 0;
+
+    /**
+     * Test a pair where at least one of the colliders is a CompoundCollider, by testing the children whose bounds
+     * overlap the other collider
+     * The deepest of the children's collisions is used, so the worst overlap is pushed apart first
+     * @param collider1 The collider the collision test is for
+     * @param collider2 The collider the collision test is against
+     * @param findPenetration Whether the depth and normal are needed, if not the test stops at the first child to overlap
+     * @return The information about the two colliders collision
+     */
+    CollisionResult testCompoundCollision(const Collider* collider1, const Collider* collider2, bool findPenetration);
+
+    /**
+     * Test a pair where at least one of the colliders is a TriangleMeshCollider or a HeightfieldCollider, by testing the
+     * triangles near the other collider
+     * The deepest of the triangles' collisions is used, the same as for compounds. Triangle meshes and heightfields
+     * don't collide with each other
+     * @param collider1 The collider the collision test is for
+     * @param collider2 The collider the collision test is against
+     * @param findPenetration Whether the depth and normal are needed, if not the test stops at the first triangle to overlap
+     * @return The information about the two colliders collision
+     */
+    CollisionResult testConcaveCollision(const Collider* collider1, const Collider* collider2, bool findPenetration);
+
+    /**
+     * Find the distance between a TriangleMeshCollider or a HeightfieldCollider and a collider that isn't a compound,
+     * a triangle mesh or a heightfield
+     * The search around the collider is widened until it holds the closest triangle, so far away triangles aren't tested
+     * @param concave The triangle mesh or heightfield the test is for
+     * @param collider The collider the test is against
+     * @return The information about the distance between the colliders
+     */
+    DistanceResult testConcaveDistance(const Collider* concave, const Collider* collider);
+
+    /**
+     * Test triangles against a collider, with the triangle test for the collider's type or testGenericTriangles
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param collider The collider the collision test is against, which isn't a compound, a triangle mesh or a heightfield
+     * @param findPenetration Whether the depth and normal are needed
+     * @return The deepest of the triangles' collisions with the collider
+     */
+    CollisionResult testTriangles(const Triangle* triangles, size_t triangleCount, const Collider* collider, bool findPenetration);
+
+protected:
+    /**
+     * Test two colliders for collision when there is no pair test for their types
+     * Neither collider is a CompoundCollider, those are split into their children first
+     * @param collider1 The collider the collision test is for
+     * @param collider2 The collider the collision test is against
+     * @return The information about the two colliders collision
+     */
+    virtual CollisionResult testGenericCollision(const Collider* collider1, const Collider* collider2) = 0;
+
+    /**
+     * Test if two colliders overlap when there is no pair test for their types
+     * Defaults to testGenericCollision, engines should override it if they can skip finding the penetration
+     * @param collider1 The collider the test is for
+     * @param collider2 The collider the test is against
+     * @return true if the colliders overlap
+     */
+    virtual bool testGenericIntersection(const Collider* collider1, const Collider* collider2);
+
+    /**
+     * Find the distance between two colliders, neither of which is a CompoundCollider
+     * @param collider1 The collider the test is for
+     * @param collider2 The collider the test is against
+     * @return The information about the distance between the colliders
+     */
+    virtual DistanceResult testGenericDistance(const Collider* collider1, const Collider* collider2) = 0;
+
+    /**
+     * Test triangles against a collider for collision when there is no triangle test for the collider's type
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param collider The collider the collision test is against, which isn't a compound, a triangle mesh or a heightfield
+     * @param findPenetration Whether the depth and normal are needed, if not only collided is set and the test can
+     * stop at the first triangle to overlap
+     * @return The deepest of the triangles' collisions with the collider
+     */
+    virtual CollisionResult testGenericTriangles(const Triangle* triangles, size_t triangleCount, const Collider* collider, bool findPenetration) = 0;
+
+    /**
+     * Find the distance between a triangle and a collider
+     * @param triangle The triangle the test is for
+     * @param collider The collider the test is against, which isn't a compound, a triangle mesh or a heightfield
+     * @return The information about the distance between the triangle and the collider
+     */
+    virtual DistanceResult testGenericTriangleDistance(const Triangle& triangle, const Collider* collider) = 0;
+
 public:
     Scene* scene;
 
+    /** Statistics from the last call to getPotentialCollisionPairs */
+    BroadPhaseStats broadPhaseStats;
+
     /**
      * Get the actors that may be colliding with the given the actor
      * @param actor The actor to test
@@ -37,11 +208,95 @@ public:
      */
     bool getNearbyColliders(Actor* actor, std::vector<Actor*>& destPotentialActors);
 
+    /**
+     * Get every pair of actors that may be colliding
+     * Each pair is only given once, so each pair only needs testing once
+     * Pairs where both actors are asleep are left out, as their result can't have changed since they were last tested
+     * @param destPairs A vector to store the potentially colliding pairs in
+     * @return true if there are any potential collisions
+     */
+    bool getPotentialCollisionPairs(std::vector<std::pair<Actor*, Actor*>>& destPairs);
+
+    /**
+     * Registers the closed form tests for the primitive colliders
+     */
+    CollisionEngine();
+
+    virtual ~CollisionEngine() = default;
+
+    /**
+     * Set the test used for a pair of collider types, it is also used with the types the other way round
+     * @param type1 The type of the collider the test is for
+     * @param type2 The type of the collider the test is against
+     * @param test The test, or nullptr to use testGenericCollision
+     */
+    void setPairTest(ColliderType type1, ColliderType type2, PairTest test);
+
+    /**
+     * Set the test used for triangles of concave colliders against a collider type
+     * @param type The type of the collider the triangles are tested against
+     * @param test The test, or nullptr to use testGenericTriangle
+     */
+    void setTriangleTest(ColliderType type, TriangleTest test);
+
     /**
      * Test two actors for collision
      * @param actor1 The actor the collision test is for
      * @param actor2 The actor the collision test is against
      * @return The information about the two actors collision
      */
-    virtual CollisionResult testCollision(Actor* actor1, Actor* actor2) = 0;
+    CollisionResult testCollision(Actor* actor1, Actor* actor2);
+
+    /**
+     * Test two colliders for collision
+     * @param collider1 The collider the collision test is for
+     * @param collider2 The collider the collision test is against
+     * @return The information about the two colliders collision
+     */
+    CollisionResult testCollision(const Collider* collider1, const Collider* collider2);
+
+    /**
+     * Test if two actors overlap, without finding how far they penetrate
+     * @param actor1 The actor the test is for
+     * @param actor2 The actor the test is against
+     * @return true if the actors overlap
+     */
+    bool testIntersection(Actor* actor1, Actor* actor2);
+
+    /**
+     * Test if two colliders overlap, without finding how far they penetrate
+     * @param collider1 The collider the test is for
+     * @param collider2 The collider the test is against
+     * @return true if the colliders overlap
+     */
+    bool testIntersection(const Collider* collider1, const Collider* collider2);
+
+    /**
+     * Find the distance between two actors and their closest points, for proximity tests that don't need penetration
+     * @param actor1 The actor the test is for
+     * @param actor2 The actor the test is against
+     * @return The information about the distance between the actors
+     */
+    DistanceResult testDistance(Actor* actor1, Actor* actor2);
+
+    /**
+     * Find the distance between two colliders and their closest points
+     * A CompoundCollider is as close as its closest child, and a TriangleMeshCollider or HeightfieldCollider as its
+     * closest triangle
+     * @param collider1 The collider the test is for
+     * @param collider2 The collider the test is against
+     * @return The information about the distance between the colliders
+     */
+    DistanceResult testDistance(const Collider* collider1, const Collider* collider2);
+
+    /**
+     * Test every pair for collision, split between the threads of the thread pool
+     * Only pairs where both actors BLOCK need the normal and depth to be pushed apart, so the rest only have
+     * testIntersection run on them, and their results only have collided set
+     * Each result only depends on its pair, so the results are the same no matter how many threads there are
+     * @param pairs The pairs of actors to test, the actors must not be moved until this returns
+     * @param destResults A vector to store the results in, the result of each pair is at the same index as the pair
+     * @param threadPool The thread pool to run the tests on
+     */
+    virtual void testCollisions(const std::vector<std::pair<Actor*, Actor*>>& pairs, std::vector<CollisionResult>& destResults, ThreadPool& threadPool);
 };
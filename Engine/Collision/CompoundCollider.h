@@ -0,0 +1,114 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Collider.h"
+#include <Engine/FlatBVH.h>
+
+/**
+ * A collider made of other colliders, each with its own transform relative to the compound
+ * The compound owns its children, deleting them when it is deleted, and passes its lifecycle calls on to them.
+ * The children are kept in a small bounding volume hierarchy in the compound's space, so a collision test only reaches
+ * the children whose bounds overlap the other collider. The hierarchy is rebuilt when a child is added, so children
+ * shouldn't be moved relative to the compound after they are added.
+ */
+class CompoundCollider : public Collider {
+    /** Nodes with this many children or fewer aren't split */
+    static constexpr uint32_t MAX_LEAF_CHILDREN = 2;
+
+    /** The child colliders, with the children of each leaf together */
+    std::vector<Collider*> children;
+    /** The bounds of each of children in the compound's space */
+    std::vector<BoundingBox> childBounds;
+    /** The hierarchy over children, in the compound's space */
+    FlatBVH hierarchy{MAX_LEAF_CHILDREN};
+
+    /**
+     * Find the bounds of a child in the compound's space, from its support points along the compound's axes
+     * @param child The child, which must already be a child of the compound
+     * @param toLocal The matrix taking world directions into the compound's space
+     * @return The bounds of the child
+     */
+    [[nodiscard]] BoundingBox getChildBounds(const Collider* child, const glm::mat3& toLocal) const;
+
+public:
+
+    explicit CompoundCollider(CollisionMode collisionMode);
+
+    CompoundCollider(const CompoundCollider&) = delete;
+
+    CompoundCollider& operator=(const CompoundCollider&) = delete;
+
+    ~CompoundCollider() override;
+
+    void onCreate() override;
+
+    void tick(double deltaTime) override;
+
+    void onDestroy() override;
+
+    /**
+     * Add a collider to the compound and rebuild the hierarchy
+     * The child's transform is relative to the compound, so it should be set before the child is added. The child
+     * collides as part of the compound, so its collision mode and filter aren't used.
+     * @param child The collider to add, which the compound takes ownership of
+     */
+    void addChild(Collider* child);
+
+    /**
+     * Get the child colliders, in the order they are stored in the hierarchy
+     * @return The children
+     */
+    [[nodiscard]] const std::vector<Collider*>& getChildren() const;
+
+    /**
+     * Get every collider under the compound that isn't a compound itself, going into child compounds
+     * @param destColliders A vector to add the colliders to
+     */
+    void getLeafColliders(std::vector<Collider*>& destColliders) const;
+
+    /**
+     * Find the children whose bounds overlap a bounding box
+     * @param bb The bounding box in world space
+     * @param function Called with each child found
+     */
+    template<typename Function>
+    void queryChildren(const BoundingBox& bb, Function&& function) const;
+
+    /**
+     * Get the bounding box of the hierarchy as it is transformed, relative to the collider's position
+     * @inherit
+     */
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Find the furthest point of any of the children, which is the furthest point of their convex hull
+     * @inherit
+     */
+    [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
+
+    /**
+     * Compound colliders have no mesh of their own, they are drawn as their children
+     * @return nullptr
+     */
+    Mesh* getRenderMesh() override;
+
+    glm::mat4 getRenderMeshTransform() override;
+};
+
+template<typename Function>
+void CompoundCollider::queryChildren(const BoundingBox& bb, Function&& function) const {
+    glm::mat4 transform = getTransform();
+    glm::mat3 toLocal = glm::inverse(glm::mat3(transform));
+    BoundingBox localBox = bb.transformed(toLocal, -(toLocal * glm::vec3(transform[3])));
+
+    hierarchy.query(localBox, [&](uint32_t child) {
+        if (childBounds[child].overlaps(localBox)) function(children[child]);
+    });
+}
@@ -0,0 +1,39 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+/**
+ * The convex hull of a set of points, with the adjacency of its vertices so support points can be found by hill climbing
+ */
+struct ConvexHull {
+    /** The vertices on the hull */
+    std::vector<glm::vec3> vertices;
+    /** The triangles of the hull as indices into vertices, wound counter-clockwise when viewed from outside */
+    std::vector<uint32_t> indices;
+    /** Where each vertex's neighbours start in adjacency, with an extra entry at the end for the total */
+    std::vector<uint32_t> adjacencyOffsets;
+    /** The neighbours of every vertex, one after the other */
+    std::vector<uint32_t> adjacency;
+
+    /**
+     * Build the convex hull of the given points
+     * @param points The points to build the hull of
+     * @return false if the points are flat, so have no volume to build a hull around, or too degenerate to close a hull
+     */
+    bool build(const std::vector<glm::vec3>& points);
+
+    /**
+     * Find the vertex furthest in the given direction by walking the hull from the given vertex
+     * Every step moves to a further neighbour, so starting near the answer takes very few steps
+     * @param direction The direction to search in
+     * @param startVertex The index of the vertex to start from
+     * @return the index of the furthest vertex
+     */
+    [[nodiscard]] uint32_t hillClimb(glm::vec3 direction, uint32_t startVertex) const;
+};
@@ -4,8 +4,12 @@
 
 #pragma once
 #include "CollisionEngine.h"
+#include "Simplex.h"
+#include "GJKPairCache.h"
 
 #include <vector>
+#include <array>
+#include <cstdint>
 
 enum class GJKState {
     BUILDING,
@@ -13,53 +17,183 @@ enum class GJKState {
     HIT
 };
 
+/**
+ * Fixed capacity working memory for EPA
+ * One of these is kept per thread so expanding the polytope never allocates
+ */
+struct EPAScratch {
+    /** EPA gives up once the polytope has more than 30 points, so it can never have more than this */
+    static constexpr size_t MAX_POINTS = 32;
+    static constexpr size_t MAX_FACES = 8 * MAX_POINTS;
+    static constexpr size_t MAX_EDGES = 3 * MAX_FACES;
+
+    struct Edge {
+        uint8_t a, b;
+        /** False once the reverse of the edge has been found, so it is not on the horizon */
+        bool unique;
+        /** The index of the next edge with the same points, or -1 */
+        int16_t next;
+    };
+
+    std::array<glm::vec3, MAX_POINTS> points;
+    size_t pointCount = 0;
+
+    /** 3 indices into points per face */
+    std::array<uint32_t, MAX_FACES * 3> indices;
+    /** Normal and distance of each face packed into a vec4 */
+    std::array<glm::vec4, MAX_FACES> normals;
+    size_t faceCount = 0;
+
+    /** The edges of the faces removed this expansion, in the order they were found */
+    std::array<Edge, MAX_EDGES> edges;
+    size_t edgeCount = 0;
+    /**
+     * The index in edges of the first and last unique edge for each pair of point indices, or -1
+     * This lets reverse edges be found without searching the edges
+     */
+    std::array<std::array<int16_t, MAX_POINTS>, MAX_POINTS> edgeHeads, edgeTails;
+
+    EPAScratch();
+
+    /**
+     * Set the polytope to the tetrahedron formed by the given simplex
+     * @param simplex A simplex of 4 points
+     */
+    void reset(const Simplex& simplex);
+};
+
 class GJKCollisionEngine : public CollisionEngine {
 protected:
+    /** The last search direction and support hints of each pair tested with GJK, used to start the next test of the pair */
+    GJKPairCache pairCache;
+
     /**
-     * Calculate the support point in the given direction
-     * @param actor1 The first actor whose collision to use to calculate the support point
-     * @param actor2 The second actor whose collision to use to calculate the support point
+     * Calculate the support point of the Minkowski difference of two colliders in the given direction
+     * @tparam SupportA The type of the support function of the first collider
+     * @tparam SupportB The type of the support function of the second collider
+     * @param supportA The support function of the first collider
+     * @param supportB The support function of the second collider
      * @param direction The direction the support point is in
      * @return the support point
      */
-    glm::vec3 getSupportPoint(Actor* actor1, Actor* actor2, glm::vec3 direction) const;
+    template<typename SupportA, typename SupportB>
+    static glm::vec3 getSupportPoint(const SupportA& supportA, const SupportB& supportB, glm::vec3 direction);
+
+    GJKState testSimplex(Simplex& points, glm::vec3& direction) const;
+    GJKState lineCase(Simplex& points, glm::vec3& direction) const;
+    GJKState triangleCase(Simplex& points, glm::vec3& direction) const;
+    GJKState simplexCase(Simplex& points, glm::vec3& direction) const;
+
+    /**
+     * Test two colliders for collision with GJK, then EPA if they collide
+     * This is instantiated in GJKCollisionEngine.cpp for every pair of support functions in SupportFunctions.h
+     * @tparam SupportA The type of the support function of the first collider
+     * @tparam SupportB The type of the support function of the second collider
+     * @param supportA The support function of the collider the collision test is for
+     * @param supportB The support function of the collider the collision test is against
+     * @param searchDirection The direction to start searching in, or 0 to start from the direction between the
+     * colliders. Set to the direction to start the next test of the pair from, which separates the colliders if they
+     * didn't collide, or the collision normal if they did
+     * @param warmStarted If searchDirection came from the pair cache, so an early out is counted as one
+     * @param findPenetration Whether to run EPA when the colliders collide, if not only collided is set
+     * @return The information about the two colliders collision
+     */
+    template<typename SupportA, typename SupportB>
+    CollisionResult gjk(const SupportA& supportA, const SupportB& supportB, glm::vec3& searchDirection, bool warmStarted, bool findPenetration);
 
-    GJKState testSimplex(std::vector<glm::vec3>& points, glm::vec3& direction) const;
-    GJKState lineCase(std::vector<glm::vec3>& points, glm::vec3& direction) const;
-    GJKState triangleCase(std::vector<glm::vec3>& points, glm::vec3& direction) const;
-    GJKState simplexCase(std::vector<glm::vec3>& points, glm::vec3& direction) const;
+    /**
+     * Test two colliders with GJK, starting from and updating the pair cache
+     * @param collider1 The collider the collision test is for
+     * @param collider2 The collider the collision test is against
+     * @param findPenetration Passed to gjk
+     * @return The information about the two colliders collision
+     */
+    CollisionResult testCachedGJK(const Collider* collider1, const Collider* collider2, bool findPenetration);
+
+    /**
+     * Find the distance between two colliders with GJK, keeping track of the closest point on the simplex instead
+     * of trying to enclose the origin
+     * @tparam SupportA The type of the support function of the first collider
+     * @tparam SupportB The type of the support function of the second collider
+     * @param supportA The support function of the collider the test is for
+     * @param supportB The support function of the collider the test is against
+     * @return The information about the distance between the colliders
+     */
+    template<typename SupportA, typename SupportB>
+    DistanceResult gjkDistance(const SupportA& supportA, const SupportB& supportB) const;
+
+    /**
+     * Call the function with the support function for the collider's type
+     * @tparam Function The type of the function, taking the support function as its only parameter
+     * @param collider The collider to get the support function of
+     * @param hint The hull vertex to start searching from, set to the vertex last found, if the collider has a hull
+     * @param function The function to call
+     * @return The result of the function
+     */
+    template<typename Function>
+    static auto visitSupport(const Collider* collider, uint32_t& hint, Function&& function);
 
     /*=================================*/
     /* EPA                             */
     /*=================================*/
     /**
      * Calculate the normals of the faces of the polytope
-     * @param polytope The polytope to calculate the normals for
-     * @param indices A list of indices denoting the faces of the polytope
-     * @param destNormals The Vector of packed Vec4s (vec3 normal, float distance) to store the normals in
-     * @return The index of the normal with the shortest distance
+     * @param scratch The polytope
+     * @param firstFace The index of the first face to calculate the normal of, all faces after it are calculated too
+     * @return The index of the face with the shortest distance out of the calculated faces
      */
-    size_t getFaceNormals(std::vector<glm::vec3>& polytope, std::vector<size_t> indices, std::vector<glm::vec4>& destNormals) const;
+    size_t getFaceNormals(EPAScratch& scratch, size_t firstFace) const;
 
     /**
-     * Add the given edges to the destEdges array if their reverse doe
-     * @param indices The indices the edge indexes reference
-     * @param edgeIndexA The index of the first point of the edge
-     * @param edgeIndexB The index of the second point of the edge
-     * @param destEdges The vector to store the edge in
+     * Add the given edge to the edges of the scratch, unless its reverse is already there, in which case the reverse
+     * is marked as not unique
+     * @param scratch The scratch storing the edges
+     * @param a The index of the first point of the edge
+     * @param b The index of the second point of the edge
+     * @return false if the edge table is full
      */
-    void addIfUniqueEdge(std::vector<size_t>& indices, size_t edgeIndexA, size_t edgeIndexB, std::vector<std::pair<size_t, size_t>>& destEdges) const;
+    bool addIfUniqueEdge(EPAScratch& scratch, uint32_t a, uint32_t b) const;
 
     /**
      * Expanding Polytobe Algorithm
      * Expands the simplex until it finds the face with the normal that has the shortest penetration distance
-     * @param polytope The vector containing the points of the polytube (should be the simplex)
-     * @param actor1 The actor the collision is being tested for
-     * @param actor2 The actor the collision is being tested against
+     * @tparam SupportA The type of the support function of the first collider
+     * @tparam SupportB The type of the support function of the second collider
+     * @param simplex The simplex enclosing the origin found by GJK
+     * @param supportA The support function of the collider the collision is being tested for
+     * @param supportB The support function of the collider the collision is being tested against
      * @return The collision data
      */
-    CollisionResult epa(std::vector<glm::vec3>& polytope, Actor* actor1, Actor* actor2) const;
-public:
+    template<typename SupportA, typename SupportB>
+    CollisionResult epa(const Simplex& simplex, const SupportA& supportA, const SupportB& supportB) const;
+
+    /** @inherit */
+    CollisionResult testGenericCollision(const Collider* collider1, const Collider* collider2) override;
+
+    /**
+     * Stops as soon as GJK encloses the origin, without running EPA
+     * @inherit
+     */
+    bool testGenericIntersection(const Collider* collider1, const Collider* collider2) override;
+
+    /** @inherit */
+    DistanceResult testGenericDistance(const Collider* collider1, const Collider* collider2) override;
+
+    /**
+     * Tests each triangle with GJK and EPA, without the pair cache as triangles aren't kept between tests
+     * @inherit
+     */
+    CollisionResult testGenericTriangles(const Triangle* triangles, size_t triangleCount, const Collider* collider, bool findPenetration) override;
+
     /** @inherit */
-    CollisionResult testCollision(Actor* actor1, Actor* actor2) override;
+    DistanceResult testGenericTriangleDistance(const Triangle& triangle, const Collider* collider) override;
+public:
+    /** Statistics about the pair cache from the last call to testCollisions */
+    PairCacheStats pairCacheStats;
+
+    /**
+     * Test every pair for collision, then forget the cached directions of pairs that weren't tested
+     * @inherit
+     */
+    void testCollisions(const std::vector<std::pair<Actor*, Actor*>>& pairs, std::vector<CollisionResult>& destResults, ThreadPool& threadPool) override;
 };
@@ -0,0 +1,120 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * Statistics about the GJK pair cache over the most recent set of collision tests
+ */
+struct PairCacheStats {
+    /** The number of tests that found an entry for their pair */
+    size_t hits = 0;
+    /** The number of tests that had no entry for their pair */
+    size_t misses = 0;
+    /** The number of hits where the cached axis still separated the pair, so GJK stopped straight away */
+    size_t earlyOuts = 0;
+    /** The number of entries removed because their pair wasn't tested */
+    size_t expired = 0;
+
+    /**
+     * Get the fraction of the tests that found an entry for their pair
+     * @return The hit rate, between 0 and 1
+     */
+    [[nodiscard]] float getHitRate() const {
+        size_t lookups = hits + misses;
+        return lookups == 0 ? 0.f : static_cast<float>(hits) / static_cast<float>(lookups);
+    }
+};
+
+/**
+ * The last direction GJK searched in for each pair of colliders, used to start the next test of the pair
+ * Pairs barely move between frames, so if the direction separated the pair last time it usually still does, and if
+ * it didn't it is still a better place to start than the direction between the colliders
+ * The hull vertex each collider's last support point was found at is kept too, so hill climbing the hulls of the next
+ * test starts next to the answer. Each pair only depends on its own earlier tests, so results don't depend on how the
+ * pairs are split between threads
+ * Safe to use from several threads at once, as long as each pair is only tested by one thread at a time
+ */
+class GJKPairCache {
+    struct Entry {
+        /** The direction from the lower id collider's perspective */
+        glm::vec3 direction;
+        /** The support hint of the lower id collider, then of the higher id collider */
+        std::array<uint32_t, 2> hints;
+        /** The generation the entry was last used in */
+        uint64_t lastUsed;
+    };
+
+    /** The entries are split between shards with their own lock, so threads rarely wait on each other */
+    static constexpr size_t SHARD_COUNT = 64;
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+    };
+    std::array<Shard, SHARD_COUNT> shards;
+
+    /** Incremented by each call to expire */
+    uint64_t generation = 0;
+
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+    std::atomic<size_t> earlyOuts{0};
+
+    /**
+     * Get the key of a pair of colliders, and if their ids are the other way round to the key
+     * @param id1 The id of the collider the test is for
+     * @param id2 The id of the collider the test is against
+     * @param destFlipped Set to true if id1 is the second id in the key
+     * @return The key of the pair
+     */
+    static uint64_t getKey(uint32_t id1, uint32_t id2, bool& destFlipped);
+
+    Shard& getShard(uint64_t key);
+public:
+    /**
+     * Find the direction and support hints stored for a pair of colliders, marking the pair as used
+     * @param id1 The id of the collider the test is for
+     * @param id2 The id of the collider the test is against
+     * @param destDirection Set to the stored direction, from the perspective of the first collider
+     * @param destHint1 Set to the stored support hint of the first collider
+     * @param destHint2 Set to the stored support hint of the second collider
+     * @return false if there is no entry for the pair
+     */
+    bool find(uint32_t id1, uint32_t id2, glm::vec3& destDirection, uint32_t& destHint1, uint32_t& destHint2);
+
+    /**
+     * Store the direction and support hints for a pair of colliders
+     * @param id1 The id of the collider the test is for
+     * @param id2 The id of the collider the test is against
+     * @param direction The direction, from the perspective of the first collider
+     * @param hint1 The support hint of the first collider
+     * @param hint2 The support hint of the second collider
+     */
+    void store(uint32_t id1, uint32_t id2, glm::vec3 direction, uint32_t hint1, uint32_t hint2);
+
+    /**
+     * Count a test that stopped straight away because the stored direction still separated the pair
+     */
+    void countEarlyOut();
+
+    /**
+     * Remove the entries of pairs that haven't been tested since the last call, and start counting statistics again
+     * Must not be called while any thread is using the cache
+     * @return The statistics since the last call
+     */
+    PairCacheStats expire();
+
+    /**
+     * Remove every entry
+     */
+    void clear();
+};
@@ -0,0 +1,220 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "Collider.h"
+#include "Triangle.h"
+
+/**
+ * A concave collider for terrain, made of a grid of heights in the collider's xz plane
+ * Each height is stored in 16 bits, and the lowest and highest height of each square chunk of cells is kept at every
+ * level of a quadtree, so a collision test skips whole chunks that are above or below the other collider and only
+ * reaches the cells under it. Each cell is two triangles, which are tested the same way as a TriangleMeshCollider's.
+ * Heightfields aren't tested against each other or against triangle meshes, they are meant for actors that don't move.
+ */
+class HeightfieldCollider : public Collider {
+    /** The cells along each side of a chunk at the finest level, each level above doubles it */
+    static constexpr uint32_t CHUNK_SIZE = 8;
+    /** The most levels there can be, enough for a grid with 2^32 cells along each side */
+    static constexpr uint32_t MAX_LEVELS = 32;
+
+    struct HeightRange {
+        /** The lowest quantized height in the chunk */
+        uint16_t min;
+        /** The highest quantized height in the chunk */
+        uint16_t max;
+    };
+
+    struct Level {
+        /** The chunks along x */
+        uint32_t chunksX;
+        /** The chunks along z */
+        uint32_t chunksZ;
+        /** The heights in each chunk, one row of chunks along x after another */
+        std::vector<HeightRange> ranges;
+    };
+
+    /** The heights along x */
+    uint32_t columns = 0;
+    /** The heights along z */
+    uint32_t rows = 0;
+    /** The distance between neighbouring heights along x and z */
+    float spacing;
+    /** The height each step of a quantized height is worth */
+    float heightScale = 0;
+    /** The height of a quantized height of 0 */
+    float heightOffset = 0;
+    /** The quantized heights, one row along x after another */
+    std::vector<uint16_t> heights;
+    /** The height ranges of the chunks, the finest level first and the last level a single chunk */
+    std::vector<Level> levels;
+    /** The mesh drawn for the collider, made the first time it is needed */
+    Mesh renderMesh;
+
+    /**
+     * Quantize heights and build the levels from them
+     * @param newHeights The heights, one row along x after another
+     */
+    void setHeights(const std::vector<float>& newHeights);
+
+    /**
+     * Build the levels from the quantized heights
+     */
+    void buildLevels();
+
+    /**
+     * Get a height in the collider's space
+     * @param x The column of the height
+     * @param z The row of the height
+     * @return The height
+     */
+    [[nodiscard]] float getHeight(uint32_t x, uint32_t z) const {
+        return heightOffset + heightScale * static_cast<float>(heights[static_cast<size_t>(z) * columns + x]);
+    }
+
+public:
+
+    /**
+     * Make a heightfield from a grid of heights
+     * Heights are quantized to 16 bits between the lowest and highest height, so they are within half a step of the
+     * given heights. A grid with fewer than 2 heights along either side has no cells, and never collides
+     * @param collisionMode The collision mode of the collider
+     * @param columns The number of heights along x
+     * @param rows The number of heights along z
+     * @param spacing The distance between neighbouring heights along x and z, the grid starts at the collider's origin
+     * @param heights The heights, one row along x after another, there must be columns * rows of them
+     */
+    HeightfieldCollider(CollisionMode collisionMode, uint32_t columns, uint32_t rows, float spacing, const std::vector<float>& heights);
+
+    /**
+     * Save the quantized heights, the levels are built again when they are loaded
+     * @param filePath The path to save to
+     * @return true if the file was saved
+     */
+    bool saveToFile(const std::string& filePath) const;
+
+    /**
+     * Replace the heights with ones saved by saveToFile
+     * If the file can't be loaded the collider is left as it was
+     * @param filePath The path to load from
+     * @return true if the file was loaded
+     */
+    bool loadFromFile(const std::string& filePath);
+
+    /**
+     * Get the number of triangles in the collider, two for each cell
+     * @return The number of triangles
+     */
+    [[nodiscard]] size_t getTriangleCount() const;
+
+    /**
+     * Find the triangles of the cells under a bounding box whose heights overlap it
+     * @param bb The bounding box in world space
+     * @param function Called with each triangle found, in world space
+     */
+    template<typename Function>
+    void queryTriangles(const BoundingBox& bb, Function&& function) const;
+
+    /**
+     * Get the bounding box of the grid as it is transformed, relative to the collider's position
+     * @inherit
+     */
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Find the furthest corner of the grid's bounds, which is never nearer than the furthest point of the surface
+     * This is only meant for building the bounds of a CompoundCollider the heightfield is part of
+     * @inherit
+     */
+    [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
+
+    Mesh* getRenderMesh() override;
+
+    glm::mat4 getRenderMeshTransform() override;
+};
+
+template<typename Function>
+void HeightfieldCollider::queryTriangles(const BoundingBox& bb, Function&& function) const {
+    if (levels.empty()) return;
+
+    glm::mat4 transform = getTransform();
+    glm::mat3 toLocal = glm::inverse(glm::mat3(transform));
+    BoundingBox localBox = bb.transformed(toLocal, -(toLocal * glm::vec3(transform[3])));
+    glm::vec3 localMin = localBox.min / spacing;
+    glm::vec3 localMax = localBox.max / spacing;
+
+    // The cells under the box, clamped in floats first so boxes far off the grid can't overflow the conversion
+    float cellsX = static_cast<float>(columns - 1);
+    float cellsZ = static_cast<float>(rows - 1);
+    if (!(localMax.x >= 0 && localMax.z >= 0 && localMin.x <= cellsX && localMin.z <= cellsZ)) return;
+    auto firstX = std::min(static_cast<uint32_t>(std::max(localMin.x, 0.f)), columns - 2);
+    auto firstZ = std::min(static_cast<uint32_t>(std::max(localMin.z, 0.f)), rows - 2);
+    auto lastX = std::min(static_cast<uint32_t>(std::min(localMax.x, cellsX)), columns - 2);
+    auto lastZ = std::min(static_cast<uint32_t>(std::min(localMax.z, cellsZ)), rows - 2);
+    float minHeight = localBox.min.y;
+    float maxHeight = localBox.max.y;
+
+    struct Chunk {
+        uint32_t level, x, z;
+    };
+    // Each level down leaves at most three more chunks on the stack
+    Chunk stack[3 * MAX_LEVELS + 1];
+    size_t stackSize = 0;
+    stack[stackSize++] = {static_cast<uint32_t>(levels.size() - 1), 0, 0};
+
+    while (stackSize > 0) {
+        Chunk chunk = stack[--stackSize];
+        const Level& level = levels[chunk.level];
+        const HeightRange& range = level.ranges[static_cast<size_t>(chunk.z) * level.chunksX + chunk.x];
+        if (heightOffset + heightScale * range.min > maxHeight || heightOffset + heightScale * range.max < minHeight) continue;
+
+        if (chunk.level > 0) {
+            // Only the children under the box are pushed, the child chunks are half the size so their indices double
+            uint64_t childSize = static_cast<uint64_t>(CHUNK_SIZE) << (chunk.level - 1);
+            const Level& children = levels[chunk.level - 1];
+            for (uint32_t z = chunk.z * 2; z < std::min(chunk.z * 2 + 2, children.chunksZ); ++z) {
+                if (z * childSize > lastZ || (z + 1) * childSize <= firstZ) continue;
+                for (uint32_t x = chunk.x * 2; x < std::min(chunk.x * 2 + 2, children.chunksX); ++x) {
+                    if (x * childSize > lastX || (x + 1) * childSize <= firstX) continue;
+                    stack[stackSize++] = {chunk.level - 1, x, z};
+                }
+            }
+            continue;
+        }
+
+        uint32_t endX = std::min(lastX, chunk.x * CHUNK_SIZE + CHUNK_SIZE - 1);
+        uint32_t endZ = std::min(lastZ, chunk.z * CHUNK_SIZE + CHUNK_SIZE - 1);
+        for (uint32_t z = std::max(firstZ, chunk.z * CHUNK_SIZE); z <= endZ; ++z) {
+            for (uint32_t x = std::max(firstX, chunk.x * CHUNK_SIZE); x <= endX; ++x) {
+                float height00 = getHeight(x, z);
+                float height10 = getHeight(x + 1, z);
+                float height01 = getHeight(x, z + 1);
+                float height11 = getHeight(x + 1, z + 1);
+
+                // The cell is split along the diagonal from (x + 1, z) to (x, z + 1), which both triangles share
+                float diagonalMin = std::min(height10, height01);
+                float diagonalMax = std::max(height10, height01);
+                bool first = std::min(height00, diagonalMin) <= maxHeight && std::max(height00, diagonalMax) >= minHeight;
+                bool second = std::min(height11, diagonalMin) <= maxHeight && std::max(height11, diagonalMax) >= minHeight;
+                if (!first && !second) continue;
+
+                auto toWorld = [&](uint32_t cornerX, float height, uint32_t cornerZ) {
+                    return glm::vec3(transform * glm::vec4(static_cast<float>(cornerX) * spacing, height, static_cast<float>(cornerZ) * spacing, 1));
+                };
+                glm::vec3 corner10 = toWorld(x + 1, height10, z);
+                glm::vec3 corner01 = toWorld(x, height01, z + 1);
+                // Both triangles go anticlockwise seen from above, so their front faces point up
+                if (first) function(Triangle{toWorld(x, height00, z), corner01, corner10});
+                if (second) function(Triangle{corner10, corner01, toWorld(x + 1, height11, z + 1)});
+            }
+        }
+    }
+}
@@ -8,17 +8,42 @@
 #include "Collider.h"
 #include "Mesh/Mesh.h"
 #include "Mesh/StaticMesh.h"
-
+#include "SupportPointCloud.h"
+#include "ConvexHull.h"
+
+/**
+ * A convex collider, the convex hull of a mesh
+ * Subclasses that change findFurthestPointInDirection are still searched through it, rather than the hull being
+ * searched directly like it is for a MeshCollider
+ */
 class MeshCollider : public Collider {
     Mesh* mesh;
+    /** The convex hull of the mesh, made when the collider is created */
+    ConvexHull hull;
+    /** A copy of the mesh's vertices laid out for SIMD, only used if the mesh is flat and has no hull */
+    SupportPointCloud supportPoints;
+
+protected:
+    MeshCollider(CollisionMode collisionMode, Mesh* mesh, ColliderType colliderType);
 
 public:
     explicit MeshCollider(CollisionMode collisionMode, Mesh* mesh);
 
-    BoundingBox getBoundingBox() override;
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
 
     glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
 
+    /**
+     * Find the furthest point in the given direction, starting the search from the hint
+     * Searches in similar directions find points close to each other, so passing the same hint to each search of a
+     * collision test makes most searches only take a few steps. The hint only changes the result when more than one
+     * vertex is furthest
+     * @param direction The direction to search in
+     * @param hint The index of the hull vertex to start from, set to the vertex found
+     * @return The furthest point in the given direction
+     */
+    glm::vec3 findFurthestPointInDirection(glm::vec3 direction, uint32_t& hint) const;
+
     Mesh* getRenderMesh() override;
 
     glm::mat4 getRenderMeshTransform() override;
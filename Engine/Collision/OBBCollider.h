@@ -0,0 +1,66 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "Collider.h"
+
+/**
+ * A box in world space, which can be rotated
+ */
+struct OrientedBox {
+    glm::vec3 centre;
+    /** The directions of the box's sides, unit length and at right angles to each other */
+    glm::vec3 axes[3];
+    /** Half the size of the box along each of axes */
+    glm::vec3 halfExtents;
+
+    /**
+     * Find the corner of the box furthest in the given direction
+     * @param direction The direction to search in
+     * @return The corner, in world space
+     */
+    [[nodiscard]] glm::vec3 getFurthestPoint(glm::vec3 direction) const;
+};
+
+/**
+ * A box collider that rotates and scales with its actor
+ * The box is tested against other boxes with the separating axis test, and its support point for GJK is found
+ * directly from its axes, so it costs the same as an AABBCollider no matter how it is rotated.
+ */
+class OBBCollider final : public Collider {
+    static Mesh* renderMesh;
+    /** The box before the actor's transform is applied */
+    BoundingBox boundingBox;
+public:
+
+    OBBCollider(CollisionMode collisionMode, const BoundingBox& boundingBox);
+    OBBCollider(CollisionMode collisionMode, glm::vec3 min, glm::vec3 max);
+
+    /**
+     * Get the bounding box of the box as it is rotated and scaled, relative to the collider's position
+     * @inherit
+     */
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Get the box of the collider before it is rotated and scaled, relative to the collider's position
+     * @return The box of the collider
+     */
+    [[nodiscard]] const BoundingBox& getBox() const;
+
+    /**
+     * Get the box of the collider in world space, with the collider's transform applied
+     * @return The oriented box
+     */
+    [[nodiscard]] OrientedBox getWorldBox() const;
+
+    [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
+
+    Mesh* getRenderMesh() override;
+
+    glm::mat4 getRenderMeshTransform() override;
+};
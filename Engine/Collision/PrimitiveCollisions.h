@@ -0,0 +1,141 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include "CollisionEngine.h"
+#include "Collider.h"
+
+/**
+ * Closed form collision tests between primitive colliders
+ * Each test gives the same result as GJK and EPA would, the normal is from the first collider's perspective, so moving
+ * the first collider by -normal * depth separates the pair
+ */
+struct PrimitiveCollisions {
+    /** Added to the depth of every collision, the same as EPA adds, so resolved collisions end up just apart */
+    static constexpr float COLLISION_MARGIN = 0.001f;
+
+    /**
+     * Test two SphereColliders for collision
+     * @param sphere1 The sphere the collision test is for
+     * @param sphere2 The sphere the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult sphereSphere(const Collider* sphere1, const Collider* sphere2);
+
+    /**
+     * Test a SphereCollider against an AABBCollider for collision
+     * @param sphere The sphere the collision test is for
+     * @param box The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult sphereAABB(const Collider* sphere, const Collider* box);
+
+    /**
+     * Test two AABBColliders for collision
+     * @param box1 The box the collision test is for
+     * @param box2 The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult aabbAABB(const Collider* box1, const Collider* box2);
+
+    /**
+     * Test two OBBColliders for collision with the separating axis test
+     * The boxes are tested along the 3 axes of each box and the 9 cross products of their axes, and pushed apart along
+     * whichever of those they overlap least on
+     * @param box1 The box the collision test is for
+     * @param box2 The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult obbOBB(const Collider* box1, const Collider* box2);
+
+    /**
+     * Test an AABBCollider against an OBBCollider for collision, with the separating axis test
+     * @param box1 The axis aligned box the collision test is for
+     * @param box2 The oriented box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult aabbOBB(const Collider* box1, const Collider* box2);
+
+    /**
+     * Test a SphereCollider against an OBBCollider for collision
+     * @param sphere The sphere the collision test is for
+     * @param box The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult sphereOBB(const Collider* sphere, const Collider* box);
+
+    /**
+     * Test two CapsuleColliders for collision, from the closest points of their segments
+     * @param capsule1 The capsule the collision test is for
+     * @param capsule2 The capsule the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult capsuleCapsule(const Collider* capsule1, const Collider* capsule2);
+
+    /**
+     * Test a CapsuleCollider against a SphereCollider for collision
+     * @param capsule The capsule the collision test is for
+     * @param sphere The sphere the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult capsuleSphere(const Collider* capsule, const Collider* sphere);
+
+    /**
+     * Test a CapsuleCollider against an AABBCollider for collision
+     * The closest points of the capsule's segment and the box are found exactly, if the segment is inside the box the
+     * capsule is pushed out with the separating axis test instead
+     * @param capsule The capsule the collision test is for
+     * @param box The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult capsuleAABB(const Collider* capsule, const Collider* box);
+
+    /**
+     * Test a CapsuleCollider against an OBBCollider for collision, in the same way as capsuleAABB
+     * @param capsule The capsule the collision test is for
+     * @param box The box the collision test is against
+     * @return The information about the collision
+     */
+    static CollisionResult capsuleOBB(const Collider* capsule, const Collider* box);
+
+    /**
+     * Test triangles against a SphereCollider for collision, from the point on each triangle closest to the centre
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param sphere The sphere the collision test is against
+     * @return The deepest of the triangles' collisions with the sphere
+     */
+    static CollisionResult triangleSphere(const Triangle* triangles, size_t triangleCount, const Collider* sphere);
+
+    /**
+     * Test triangles against a CapsuleCollider for collision, from the closest points of each triangle and the
+     * capsule's segment, if the segment goes through a triangle the capsule is pushed out with the separating axis test
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param capsule The capsule the collision test is against
+     * @return The deepest of the triangles' collisions with the capsule
+     */
+    static CollisionResult triangleCapsule(const Triangle* triangles, size_t triangleCount, const Collider* capsule);
+
+    /**
+     * Test triangles against an AABBCollider for collision with the separating axis test
+     * Each triangle and the box are tested along the triangle's normal, the box's axes and the 9 cross products of the
+     * triangle's edges and the box's axes
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param box The box the collision test is against
+     * @return The deepest of the triangles' collisions with the box
+     */
+    static CollisionResult triangleAABB(const Triangle* triangles, size_t triangleCount, const Collider* box);
+
+    /**
+     * Test triangles against an OBBCollider for collision, in the same way as triangleAABB
+     * @param triangles The triangles the collision test is for
+     * @param triangleCount The number of triangles
+     * @param box The box the collision test is against
+     * @return The deepest of the triangles' collisions with the box
+     */
+    static CollisionResult triangleOBB(const Triangle* triangles, size_t triangleCount, const Collider* box);
+};
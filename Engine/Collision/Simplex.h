@@ -0,0 +1,52 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <array>
+#include <glm/vec3.hpp>
+
+/**
+ * A simplex of up to 4 points, stored on the stack so building it never allocates
+ * The most recently added point is always the last one
+ */
+struct Simplex {
+    std::array<glm::vec3, 4> points;
+    size_t count = 0;
+
+    Simplex() = default;
+
+    /**
+     * Add a point to the end of the simplex
+     * @param point The point to add
+     */
+    void push_back(const glm::vec3& point) {
+        points[count++] = point;
+    }
+
+    /**
+     * Replace the points of the simplex with the given triangle
+     * @param a The first point
+     * @param b The second point
+     * @param c The third point, should be the most recently added
+     */
+    void setTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        points[0] = a;
+        points[1] = b;
+        points[2] = c;
+        count = 3;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    glm::vec3& operator[](size_t index) {
+        return points[index];
+    }
+
+    const glm::vec3& operator[](size_t index) const {
+        return points[index];
+    }
+};
@@ -8,13 +8,17 @@
 
 Mesh* AABBCollider::renderMesh = Mesh::createNewMeshFromFile(FileUtils::getAssetsPath() + "/Shapes/Cube.lmesh");
 
-AABBCollider::AABBCollider(CollisionMode collisionMode, const BoundingBox& boundingBox) : Collider(collisionMode), boundingBox(boundingBox) {}
+AABBCollider::AABBCollider(CollisionMode collisionMode, const BoundingBox& boundingBox) : Collider(collisionMode, ColliderType::AABB), boundingBox(boundingBox) {}
 
 
 
-AABBCollider::AABBCollider(CollisionMode collisionMode, const glm::vec3 min, const glm::vec3 max) : Collider(collisionMode), boundingBox(min, max) {}
+AABBCollider::AABBCollider(CollisionMode collisionMode, const glm::vec3 min, const glm::vec3 max) : Collider(collisionMode, ColliderType::AABB), boundingBox(min, max) {}
 
-BoundingBox AABBCollider::getBoundingBox() {
+BoundingBox AABBCollider::getBoundingBox() const {
+    return boundingBox;
+}
+
+const BoundingBox& AABBCollider::getBox() const {
     return boundingBox;
 }
 
@@ -0,0 +1,69 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/CapsuleCollider.h"
+#include "Utils/FileUtils.h"
+
+#include <glm/glm.hpp>
+
+// There is no capsule mesh, so the capsule is drawn as a sphere stretched along its segment
+Mesh* CapsuleCollider::renderMesh = Mesh::createNewMeshFromFile(FileUtils::getAssetsPath() + "/Shapes/Sphere.lmesh");
+
+glm::vec3 Capsule::getFurthestPoint(glm::vec3 direction) const {
+    glm::vec3 point = glm::dot(direction, end - start) > 0 ? end : start;
+    float length = glm::length(direction);
+    return length > 0 ? point + direction * (radius / length) : point;
+}
+
+CapsuleCollider::CapsuleCollider(CollisionMode collisionMode, float radius, float halfHeight)
+        : Collider(collisionMode, ColliderType::CAPSULE), radius(radius), halfHeight(halfHeight) {}
+
+BoundingBox CapsuleCollider::getBoundingBox() const {
+    Capsule capsule = getWorldCapsule();
+    glm::vec3 position = getPosition();
+    return {
+        glm::min(capsule.start, capsule.end) - radius - position,
+        glm::max(capsule.start, capsule.end) + radius - position
+    };
+}
+
+float CapsuleCollider::getRadius() const {
+    return radius;
+}
+
+float CapsuleCollider::getHalfHeight() const {
+    return halfHeight;
+}
+
+Capsule CapsuleCollider::getWorldCapsule() const {
+    glm::mat4 transform = getTransform();
+    glm::vec3 centre(transform[3]);
+
+    // The y column of the transform is the collider's up axis, scaled by the transform's scale which is ignored
+    glm::vec3 axis(transform[1]);
+    float length = glm::length(axis);
+    axis = length > 0 ? axis * (halfHeight / length) : glm::vec3(0, halfHeight, 0);
+
+    return {centre - axis, centre + axis, radius};
+}
+
+glm::vec3 CapsuleCollider::findFurthestPointInDirection(glm::vec3 direction) const {
+    return getWorldCapsule().getFurthestPoint(direction) - getPosition();
+}
+
+Mesh* CapsuleCollider::getRenderMesh() {
+    return CapsuleCollider::renderMesh;
+}
+
+glm::mat4 CapsuleCollider::getRenderMeshTransform() {
+    glm::mat4 transform = getTransform();
+    float meshRadius = renderMesh != nullptr ? renderMesh->boundingBox.max.x : 1.f;
+    glm::vec3 scale = glm::vec3(radius, halfHeight + radius, radius) / meshRadius;
+
+    for (int i = 0; i < 3; ++i) {
+        float length = glm::length(glm::vec3(transform[i]));
+        if (length > 0) transform[i] *= scale[i] / length;
+    }
+    return transform;
+}
@@ -4,4 +4,9 @@
 
 #include "Collision/Collider.h"
 
-Collider::Collider(CollisionMode collisionMode) : collisionMode(collisionMode) {}
+#include <atomic>
+
+static std::atomic<uint32_t> nextColliderId{1};
+
+Collider::Collider(CollisionMode collisionMode, ColliderType colliderType) : collisionMode(collisionMode), colliderType(colliderType),
+                                                                            id(nextColliderId.fetch_add(1, std::memory_order_relaxed)) {}
@@ -3,10 +3,300 @@
 //
 
 #include "Collision/CollisionEngine.h"
+#include "Collision/PrimitiveCollisions.h"
+#include "Collision/CompoundCollider.h"
+#include "Collision/TriangleMeshCollider.h"
+#include "Collision/HeightfieldCollider.h"
 #include <Scene/Scene.h>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    /**
+     * Check if a collider is split into triangles by the narrow phase
+     * @param collider The collider to check
+     * @return true for triangle meshes and heightfields
+     */
+    bool isConcave(const Collider* collider) {
+        return collider->colliderType == ColliderType::TRIANGLE_MESH || collider->colliderType == ColliderType::HEIGHTFIELD;
+    }
+
+    /**
+     * Find the triangles of a triangle mesh or heightfield near a bounding box
+     * @param concave The triangle mesh or heightfield
+     * @param bb The bounding box in world space
+     * @param function Called with each triangle found, in world space
+     */
+    template<typename Function>
+    void queryConcaveTriangles(const Collider* concave, const BoundingBox& bb, Function&& function) {
+        if (concave->colliderType == ColliderType::HEIGHTFIELD) {
+            static_cast<const HeightfieldCollider*>(concave)->queryTriangles(bb, function);
+        } else {
+            static_cast<const TriangleMeshCollider*>(concave)->queryTriangles(bb, function);
+        }
+    }
+}
+
+CollisionEngine::CollisionEngine() {
+    setPairTest(ColliderType::SPHERE, ColliderType::SPHERE, PrimitiveCollisions::sphereSphere);
+    setPairTest(ColliderType::SPHERE, ColliderType::AABB, PrimitiveCollisions::sphereAABB);
+    setPairTest(ColliderType::AABB, ColliderType::AABB, PrimitiveCollisions::aabbAABB);
+    setPairTest(ColliderType::OBB, ColliderType::OBB, PrimitiveCollisions::obbOBB);
+    setPairTest(ColliderType::AABB, ColliderType::OBB, PrimitiveCollisions::aabbOBB);
+    setPairTest(ColliderType::SPHERE, ColliderType::OBB, PrimitiveCollisions::sphereOBB);
+    setPairTest(ColliderType::CAPSULE, ColliderType::CAPSULE, PrimitiveCollisions::capsuleCapsule);
+    setPairTest(ColliderType::CAPSULE, ColliderType::SPHERE, PrimitiveCollisions::capsuleSphere);
+    setPairTest(ColliderType::CAPSULE, ColliderType::AABB, PrimitiveCollisions::capsuleAABB);
+    setPairTest(ColliderType::CAPSULE, ColliderType::OBB, PrimitiveCollisions::capsuleOBB);
+
+    setTriangleTest(ColliderType::SPHERE, PrimitiveCollisions::triangleSphere);
+    setTriangleTest(ColliderType::CAPSULE, PrimitiveCollisions::triangleCapsule);
+    setTriangleTest(ColliderType::AABB, PrimitiveCollisions::triangleAABB);
+    setTriangleTest(ColliderType::OBB, PrimitiveCollisions::triangleOBB);
+}
+
+void CollisionEngine::setPairTest(ColliderType type1, ColliderType type2, PairTest test) {
+    auto index1 = static_cast<size_t>(type1);
+    auto index2 = static_cast<size_t>(type2);
+
+    pairTests[index2][index1] = {test, true};
+    pairTests[index1][index2] = {test, false};
+}
+
+void CollisionEngine::setTriangleTest(ColliderType type, TriangleTest test) {
+    triangleTests[static_cast<size_t>(type)] = test;
+}
+
+CollisionResult CollisionEngine::testCollision(Actor* actor1, Actor* actor2) {
+    return testCollision(actor1->actorCollider, actor2->actorCollider);
+}
+
+CollisionResult CollisionEngine::testCollision(const Collider* collider1, const Collider* collider2) {
+    if (collider1->colliderType == ColliderType::COMPOUND || collider2->colliderType == ColliderType::COMPOUND) {
+        return testCompoundCollision(collider1, collider2, true);
+    }
+    if (isConcave(collider1) || isConcave(collider2)) {
+        return testConcaveCollision(collider1, collider2, true);
+    }
+
+    const PairTestEntry& entry = pairTests[static_cast<size_t>(collider1->colliderType)][static_cast<size_t>(collider2->colliderType)];
+    if (entry.test == nullptr) return testGenericCollision(collider1, collider2);
+    if (!entry.swapped) return entry.test(collider1, collider2);
+
+    CollisionResult result = entry.test(collider2, collider1);
+    result.normal = -result.normal;
+    return result;
+}
+
+bool CollisionEngine::testGenericIntersection(const Collider* collider1, const Collider* collider2) {
+    return testGenericCollision(collider1, collider2).collided;
+}
+
+bool CollisionEngine::testIntersection(Actor* actor1, Actor* actor2) {
+    return testIntersection(actor1->actorCollider, actor2->actorCollider);
+}
+
+bool CollisionEngine::testIntersection(const Collider* collider1, const Collider* collider2) {
+    if (collider1->colliderType == ColliderType::COMPOUND || collider2->colliderType == ColliderType::COMPOUND) {
+        return testCompoundCollision(collider1, collider2, false).collided;
+    }
+    if (isConcave(collider1) || isConcave(collider2)) {
+        return testConcaveCollision(collider1, collider2, false).collided;
+    }
+
+    // The pair tests are all closed form, so they cost about the same as checking for intersection anyway
+    const PairTestEntry& entry = pairTests[static_cast<size_t>(collider1->colliderType)][static_cast<size_t>(collider2->colliderType)];
+    if (entry.test == nullptr) return testGenericIntersection(collider1, collider2);
+    return entry.swapped ? entry.test(collider2, collider1).collided : entry.test(collider1, collider2).collided;
+}
+
+CollisionResult CollisionEngine::testCompoundCollision(const Collider* collider1, const Collider* collider2, bool findPenetration) {
+    if (collider1->colliderType != ColliderType::COMPOUND) {
+        CollisionResult result = testCompoundCollision(collider2, collider1, findPenetration);
+        result.normal = -result.normal;
+        return result;
+    }
+
+    BoundingBox bounds = collider2->getBoundingBox();
+    glm::vec3 position = collider2->getPosition();
+    bounds = {bounds.min + position, bounds.max + position};
+
+    // The children can be compounds too, testCollision splits those up in turn
+    CollisionResult deepest = {false, 0, glm::vec3(0)};
+    static_cast<const CompoundCollider*>(collider1)->queryChildren(bounds, [&](const Collider* child) {
+        if (deepest.collided && !findPenetration) return;
+
+        CollisionResult result = findPenetration ? testCollision(child, collider2) : CollisionResult{testIntersection(child, collider2), 0, glm::vec3(0)};
+        if (result.collided && (!deepest.collided || result.depth > deepest.depth)) deepest = result;
+    });
+    return deepest;
+}
+
+CollisionResult CollisionEngine::testConcaveCollision(const Collider* collider1, const Collider* collider2, bool findPenetration) {
+    if (!isConcave(collider1)) {
+        CollisionResult result = testConcaveCollision(collider2, collider1, findPenetration);
+        result.normal = -result.normal;
+        return result;
+    }
+    if (isConcave(collider2)) return {false};
+
+    BoundingBox bounds = collider2->getBoundingBox();
+    glm::vec3 position = collider2->getPosition();
+    bounds = {bounds.min + position, bounds.max + position};
+
+    // The triangles are gathered first so they can be tested together, kept per thread so gathering doesn't allocate
+    thread_local std::vector<Triangle> triangles;
+    triangles.clear();
+    queryConcaveTriangles(collider1, bounds, [&](const Triangle& triangle) {
+        triangles.push_back(triangle);
+    });
+    if (triangles.empty()) return {false};
+    return testTriangles(triangles.data(), triangles.size(), collider2, findPenetration);
+}
+
+CollisionResult CollisionEngine::testTriangles(const Triangle* triangles, size_t triangleCount, const Collider* collider, bool findPenetration) {
+    TriangleTest test = triangleTests[static_cast<size_t>(collider->colliderType)];
+    if (test == nullptr) return testGenericTriangles(triangles, triangleCount, collider, findPenetration);
+    return test(triangles, triangleCount, collider);
+}
+
+DistanceResult CollisionEngine::testConcaveDistance(const Collider* concave, const Collider* collider) {
+    DistanceResult closest = {false, std::numeric_limits<float>::max(), glm::vec3(0), glm::vec3(0)};
+    if (isConcave(collider)) return closest;
+
+    BoundingBox bounds = collider->getBoundingBox();
+    glm::vec3 position = collider->getPosition();
+    bounds = {bounds.min + position, bounds.max + position};
+    BoundingBox concaveBounds = concave->getBoundingBox();
+    glm::vec3 concavePosition = concave->getPosition();
+    concaveBounds = {concaveBounds.min + concavePosition, concaveBounds.max + concavePosition};
+
+    // Nothing in the concave collider can be closer than the gap between the boxes, so start the search there
+    glm::vec3 gap = glm::max(glm::max(concaveBounds.min - bounds.max, bounds.min - concaveBounds.max), glm::vec3(0));
+    glm::vec3 halfExtents = (bounds.max - bounds.min) * .5f;
+    float radius = std::max(glm::length(gap), std::max(0.001f, std::max(halfExtents.x, std::max(halfExtents.y, halfExtents.z))));
+
+    while (true) {
+        // Any triangle within radius of the collider overlaps the collider's bounds grown by radius
+        BoundingBox searchBounds(bounds.min - glm::vec3(radius), bounds.max + glm::vec3(radius));
+        queryConcaveTriangles(concave, searchBounds, [&](const Triangle& triangle) {
+            if (closest.intersecting) return;
+
+            // The gap between the boxes is a cheap lower bound, so most triangles further than the closest one so far
+            // are skipped without running GJK
+            glm::vec3 triangleMin = glm::min(triangle.a, glm::min(triangle.b, triangle.c));
+            glm::vec3 triangleMax = glm::max(triangle.a, glm::max(triangle.b, triangle.c));
+            glm::vec3 triangleGap = glm::max(glm::max(triangleMin - bounds.max, bounds.min - triangleMax), glm::vec3(0));
+            if (glm::dot(triangleGap, triangleGap) >= closest.distance * closest.distance) return;
+
+            DistanceResult result = testGenericTriangleDistance(triangle, collider);
+            if (result.intersecting || result.distance < closest.distance) closest = result;
+        });
+        if (closest.intersecting || closest.distance <= radius) return closest;
+
+        // Once the search covers the whole concave collider every triangle has been tested
+        glm::vec3 uncovered = glm::max(searchBounds.min - concaveBounds.min, concaveBounds.max - searchBounds.max);
+        if (uncovered.x <= 0.f && uncovered.y <= 0.f && uncovered.z <= 0.f) return closest;
+
+        // Every triangle closer than the closest one found so far is in the next search, so it finds the closest exactly
+        radius = closest.distance < std::numeric_limits<float>::max() ? closest.distance : radius * 2;
+    }
+}
+
+DistanceResult CollisionEngine::testDistance(Actor* actor1, Actor* actor2) {
+    return testDistance(actor1->actorCollider, actor2->actorCollider);
+}
+
+DistanceResult CollisionEngine::testDistance(const Collider* collider1, const Collider* collider2) {
+    if (collider1->colliderType != ColliderType::COMPOUND) {
+        bool swap = collider2->colliderType == ColliderType::COMPOUND
+                || (isConcave(collider2) && !isConcave(collider1));
+        if (swap) {
+            DistanceResult result = testDistance(collider2, collider1);
+            std::swap(result.closestPoint1, result.closestPoint2);
+            return result;
+        }
+
+        if (isConcave(collider1)) return testConcaveDistance(collider1, collider2);
+        return testGenericDistance(collider1, collider2);
+    }
+
+    // Any child could be the closest, so every child is tested
+    DistanceResult closest = {false, std::numeric_limits<float>::max(), glm::vec3(0), glm::vec3(0)};
+    for (const Collider* child: static_cast<const CompoundCollider*>(collider1)->getChildren()) {
+        DistanceResult result = testDistance(child, collider2);
+        if (result.intersecting) return result;
+        if (result.distance < closest.distance) closest = result;
+    }
+    return closest;
+}
+
+void CollisionEngine::testCollisions(const std::vector<std::pair<Actor*, Actor*>>& pairs, std::vector<CollisionResult>& destResults, ThreadPool& threadPool) {
+    destResults.resize(pairs.size());
+
+    threadPool.parallelFor(pairs.size(), PAIRS_PER_CHUNK, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Actor* actor1 = pairs[i].first;
+            Actor* actor2 = pairs[i].second;
+
+            if (actor1->actorCollider->collisionMode == CollisionMode::BLOCK && actor2->actorCollider->collisionMode == CollisionMode::BLOCK) {
+                destResults[i] = testCollision(actor1, actor2);
+            } else {
+                destResults[i] = {testIntersection(actor1, actor2), 0, glm::vec3(0)};
+            }
+        }
+    });
+}
 
 bool CollisionEngine::getNearbyColliders(Actor* actor, std::vector<Actor*>& destPotentialActors) {
-    scene->octree->getCloseActors(actor, destPotentialActors);
+    size_t firstActor = destPotentialActors.size();
+    scene->broadPhase->getCloseActors(actor, destPotentialActors);
+
+    // The broad phase finds every close actor, so leave out the ones the actor can't collide with
+    CollisionFilter filter = actor->getCollisionFilter();
+    destPotentialActors.erase(std::remove_if(destPotentialActors.begin() + static_cast<std::ptrdiff_t>(firstActor), destPotentialActors.end(), [&](Actor* other) {
+        return !filter.canCollideWith(other->getCollisionFilter());
+    }), destPotentialActors.end());
+
+    scene->bakeStaticActors();
+    scene->staticTree.query(actor->getWorldBoundingBox(), [&](Actor* staticActor) {
+        if (staticActor != actor && filter.canCollideWith(staticActor->getCollisionFilter())) destPotentialActors.push_back(staticActor);
+    });
 
     return !destPotentialActors.empty();
 }
+
+bool CollisionEngine::getPotentialCollisionPairs(std::vector<std::pair<Actor*, Actor*>>& destPairs) {
+    size_t firstPair = destPairs.size();
+    broadPhaseStats.candidatePairs = scene->broadPhase->getAllPotentialPairs(destPairs);
+
+    // When both actors are asleep, neither has moved since the pair was last tested, so it doesn't need testing again
+    size_t awakePairs = firstPair;
+    for (size_t i = firstPair; i < destPairs.size(); ++i) {
+        if (destPairs[i].first->asleep && destPairs[i].second->asleep) continue;
+        destPairs[awakePairs++] = destPairs[i];
+    }
+    broadPhaseStats.sleepingPairs = destPairs.size() - awakePairs;
+    destPairs.resize(awakePairs);
+
+    // Static actors are only paired with dynamic ones, as static actors can never start colliding with each other, and
+    // static actors are always asleep so only the awake actors need pairing
+    scene->bakeStaticActors();
+    if (!scene->staticTree.empty()) {
+        for (Actor* actor: scene->actors) {
+            CollisionFilter filter = actor->getCollisionFilter();
+            if (actor->asleep || filter.layers == 0) continue;
+            broadPhaseStats.candidatePairs += scene->staticTree.query(actor->getWorldBoundingBox(), [&](Actor* staticActor) {
+                if (filter.canCollideWith(staticActor->getCollisionFilter())) destPairs.emplace_back(actor, staticActor);
+            });
+        }
+    }
+    broadPhaseStats.rejectedPairs = broadPhaseStats.candidatePairs - (destPairs.size() - firstPair) - broadPhaseStats.sleepingPairs;
+
+    // A broad phase that has just been swapped in starts counting again from 0
+    size_t allocations = scene->broadPhase->getAllocationCount();
+    broadPhaseStats.allocations = allocations >= lastBroadPhaseAllocations ? allocations - lastBroadPhaseAllocations : allocations;
+    lastBroadPhaseAllocations = allocations;
+
+    return !destPairs.empty();
+}
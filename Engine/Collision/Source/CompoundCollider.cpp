@@ -0,0 +1,112 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/CompoundCollider.h"
+
+#include <glm/glm.hpp>
+#include <limits>
+
+CompoundCollider::CompoundCollider(CollisionMode collisionMode) : Collider(collisionMode, ColliderType::COMPOUND) {}
+
+CompoundCollider::~CompoundCollider() {
+    for (Collider* child: children) {
+        delete child;
+    }
+}
+
+void CompoundCollider::onCreate() {
+    for (Collider* child: children) {
+        child->onCreate();
+    }
+}
+
+void CompoundCollider::tick(double deltaTime) {
+    for (Collider* child: children) {
+        child->tick(deltaTime);
+    }
+}
+
+void CompoundCollider::onDestroy() {
+    for (Collider* child: children) {
+        child->onDestroy();
+    }
+}
+
+BoundingBox CompoundCollider::getChildBounds(const Collider* child, const glm::mat3& toLocal) const {
+    glm::vec3 offset = child->getPosition() - getPosition();
+
+    // Each row of toLocal is the world direction that one local axis measures along
+    glm::mat3 rows = glm::transpose(toLocal);
+    BoundingBox bounds;
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 direction = rows[axis];
+        bounds.min[axis] = glm::dot(direction, child->findFurthestPointInDirection(-direction) + offset);
+        bounds.max[axis] = glm::dot(direction, child->findFurthestPointInDirection(direction) + offset);
+    }
+    return bounds;
+}
+
+void CompoundCollider::addChild(Collider* child) {
+    child->setParent(this);
+    children.push_back(child);
+
+    // Bounds are measured in the compound's space, so they stay right however the compound is moved later
+    glm::mat3 toLocal = glm::inverse(glm::mat3(getTransform()));
+    childBounds.clear();
+    for (const Collider* collider: children) {
+        childBounds.push_back(getChildBounds(collider, toLocal));
+    }
+
+    std::vector<uint32_t> order;
+    hierarchy.build(childBounds, order);
+    std::vector<Collider*> sortedChildren;
+    std::vector<BoundingBox> sortedBounds;
+    sortedChildren.reserve(order.size());
+    sortedBounds.reserve(order.size());
+    for (uint32_t index: order) {
+        sortedChildren.push_back(children[index]);
+        sortedBounds.push_back(childBounds[index]);
+    }
+    children = std::move(sortedChildren);
+    childBounds = std::move(sortedBounds);
+}
+
+const std::vector<Collider*>& CompoundCollider::getChildren() const {
+    return children;
+}
+
+void CompoundCollider::getLeafColliders(std::vector<Collider*>& destColliders) const {
+    for (Collider* child: children) {
+        if (child->colliderType == ColliderType::COMPOUND) static_cast<const CompoundCollider*>(child)->getLeafColliders(destColliders);
+        else destColliders.push_back(child);
+    }
+}
+
+BoundingBox CompoundCollider::getBoundingBox() const {
+    if (hierarchy.empty()) return {glm::vec3(0), glm::vec3(0)};
+    return hierarchy.getBounds().transformed(glm::mat3(getTransform()));
+}
+
+glm::vec3 CompoundCollider::findFurthestPointInDirection(glm::vec3 direction) const {
+    glm::vec3 position = getPosition();
+    glm::vec3 furthest(0);
+    float maxDistance = -std::numeric_limits<float>::max();
+    for (const Collider* child: children) {
+        glm::vec3 point = child->findFurthestPointInDirection(direction) + child->getPosition() - position;
+        float distance = glm::dot(point, direction);
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            furthest = point;
+        }
+    }
+    return furthest;
+}
+
+Mesh* CompoundCollider::getRenderMesh() {
+    return nullptr;
+}
+
+glm::mat4 CompoundCollider::getRenderMeshTransform() {
+    return getTransform();
+}
@@ -0,0 +1,244 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/ConvexHull.h"
+
+#include <glm/geometric.hpp>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    struct HullFace {
+        uint32_t a, b, c;
+        glm::vec3 normal;
+        float offset;
+        /** False once the face has been replaced */
+        bool alive;
+        /** Set while finding the faces visible from a point, faces are replaced as soon as they are visible */
+        bool visible;
+        /** The points in front of this face that haven't been added to the hull yet */
+        std::vector<uint32_t> outside;
+    };
+
+    HullFace makeFace(const std::vector<glm::vec3>& points, uint32_t a, uint32_t b, uint32_t c) {
+        glm::vec3 normal = glm::normalize(glm::cross(points[b] - points[a], points[c] - points[a]));
+        return {a, b, c, normal, glm::dot(normal, points[a]), true, false, {}};
+    }
+
+    uint64_t edgeKey(uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+}
+
+bool ConvexHull::build(const std::vector<glm::vec3>& points) {
+    vertices.clear();
+    indices.clear();
+    adjacencyOffsets.clear();
+    adjacency.clear();
+    if (points.size() < 4) return false;
+
+    // Scale the tolerance to the size of the points
+    glm::vec3 min = points[0], max = points[0];
+    for (const glm::vec3& point: points) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    const float epsilon = std::max(glm::length(max - min), 1e-6f) * 1e-5f;
+
+    // Start with a tetrahedron made of the extreme points
+    uint32_t p0 = 0, p1 = 0;
+    for (uint32_t i = 1; i < points.size(); ++i) {
+        if (points[i].x < points[p0].x) p0 = i;
+        if (points[i].x > points[p1].x) p1 = i;
+    }
+    if (glm::length(points[p1] - points[p0]) < epsilon) return false;
+
+    uint32_t p2 = p0;
+    float bestDistance = 0;
+    glm::vec3 line = glm::normalize(points[p1] - points[p0]);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        glm::vec3 offset = points[i] - points[p0];
+        float distance = glm::length(offset - line * glm::dot(offset, line));
+        if (distance > bestDistance) {
+            bestDistance = distance;
+            p2 = i;
+        }
+    }
+    if (bestDistance < epsilon) return false;
+
+    uint32_t p3 = p0;
+    bestDistance = 0;
+    glm::vec3 planeNormal = glm::normalize(glm::cross(points[p1] - points[p0], points[p2] - points[p0]));
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        float distance = std::abs(glm::dot(points[i] - points[p0], planeNormal));
+        if (distance > bestDistance) {
+            bestDistance = distance;
+            p3 = i;
+        }
+    }
+    // Points only a few tolerances thick round badly enough to be left out of the hull, so count them as flat
+    if (bestDistance < 100 * epsilon) return false;
+
+    // Wind the first face away from the fourth point so every face faces outwards
+    if (glm::dot(points[p3] - points[p0], planeNormal) > 0) std::swap(p1, p2);
+
+    std::vector<HullFace> faces;
+    // The face on the left of each directed edge, so neighbouring faces can be found
+    std::unordered_map<uint64_t, uint32_t> edgeFaces;
+    auto addFace = [&](uint32_t a, uint32_t b, uint32_t c) {
+        auto faceIndex = static_cast<uint32_t>(faces.size());
+        faces.push_back(makeFace(points, a, b, c));
+        edgeFaces[edgeKey(a, b)] = faceIndex;
+        edgeFaces[edgeKey(b, c)] = faceIndex;
+        edgeFaces[edgeKey(c, a)] = faceIndex;
+    };
+
+    addFace(p0, p1, p2);
+    addFace(p0, p3, p1);
+    addFace(p1, p3, p2);
+    addFace(p2, p3, p0);
+
+    // Give each point outside the hull to the first of the given faces it is in front of
+    auto assignPoints = [&](const std::vector<uint32_t>& toAssign, uint32_t firstFace) {
+        for (uint32_t point: toAssign) {
+            for (uint32_t f = firstFace; f < faces.size(); ++f) {
+                if (glm::dot(faces[f].normal, points[point]) - faces[f].offset > epsilon) {
+                    faces[f].outside.push_back(point);
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<uint32_t> orphans;
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        if (i != p0 && i != p1 && i != p2 && i != p3) orphans.push_back(i);
+    }
+    assignPoints(orphans, 0);
+
+    // Repeatedly add the furthest point in front of a face, replacing the faces it can see
+    // New faces go on the end, so every face gets checked
+    std::vector<uint32_t> toVisit, visibleFaces;
+    std::vector<std::pair<uint32_t, uint32_t>> horizon;
+    for (uint32_t faceIndex = 0; faceIndex < faces.size(); ++faceIndex) {
+        if (!faces[faceIndex].alive || faces[faceIndex].outside.empty()) continue;
+
+        uint32_t pointIndex = faces[faceIndex].outside[0];
+        float furthest = -std::numeric_limits<float>::max();
+        for (uint32_t candidate: faces[faceIndex].outside) {
+            float distance = glm::dot(faces[faceIndex].normal, points[candidate]) - faces[faceIndex].offset;
+            if (distance > furthest) {
+                furthest = distance;
+                pointIndex = candidate;
+            }
+        }
+        const glm::vec3& point = points[pointIndex];
+
+        // Flood out to the connected visible faces, so rounding can't make the visible region split in two
+        // The edges where it stops are the horizon
+        visibleFaces.clear();
+        horizon.clear();
+        toVisit.assign(1, faceIndex);
+        faces[faceIndex].visible = true;
+        while (!toVisit.empty()) {
+            uint32_t visibleIndex = toVisit.back();
+            toVisit.pop_back();
+            visibleFaces.push_back(visibleIndex);
+
+            const uint32_t edges[3][2] = {
+                    {faces[visibleIndex].a, faces[visibleIndex].b},
+                    {faces[visibleIndex].b, faces[visibleIndex].c},
+                    {faces[visibleIndex].c, faces[visibleIndex].a}
+            };
+            for (const auto& edge: edges) {
+                // Rounding on nearly flat points can leave the hull open, which can't be walked
+                auto twin = edgeFaces.find(edgeKey(edge[1], edge[0]));
+                if (twin == edgeFaces.end()) return false;
+                uint32_t neighbour = twin->second;
+                if (faces[neighbour].visible) continue;
+
+                // The same tolerance points are given to faces with, so the visible faces and the horizon agree
+                if (glm::dot(faces[neighbour].normal, point) - faces[neighbour].offset > epsilon) {
+                    faces[neighbour].visible = true;
+                    toVisit.push_back(neighbour);
+                } else {
+                    horizon.emplace_back(edge[0], edge[1]);
+                }
+            }
+        }
+
+        // The points in front of the replaced faces need to find new ones
+        orphans.clear();
+        for (uint32_t visibleIndex: visibleFaces) {
+            HullFace& face = faces[visibleIndex];
+            face.alive = false;
+            edgeFaces.erase(edgeKey(face.a, face.b));
+            edgeFaces.erase(edgeKey(face.b, face.c));
+            edgeFaces.erase(edgeKey(face.c, face.a));
+
+            for (uint32_t orphan: face.outside) {
+                if (orphan != pointIndex) orphans.push_back(orphan);
+            }
+            face.outside = {};
+        }
+
+        auto firstNewFace = static_cast<uint32_t>(faces.size());
+        for (const auto& [a, b]: horizon) {
+            addFace(a, b, pointIndex);
+        }
+        assignPoints(orphans, firstNewFace);
+    }
+
+    // Keep only the points on the hull, and link the ones that share an edge
+    std::unordered_map<uint32_t, uint32_t> remap;
+    for (const HullFace& face: faces) {
+        if (!face.alive) continue;
+        for (uint32_t index: {face.a, face.b, face.c}) {
+            auto [entry, inserted] = remap.emplace(index, static_cast<uint32_t>(vertices.size()));
+            if (inserted) vertices.push_back(points[index]);
+            indices.push_back(entry->second);
+        }
+    }
+
+    // Every edge is in two faces, so only taking each directed edge links each neighbour once per direction
+    std::vector<std::vector<uint32_t>> neighbours(vertices.size());
+    for (size_t f = 0; f < indices.size(); f += 3) {
+        neighbours[indices[f    ]].push_back(indices[f + 1]);
+        neighbours[indices[f + 1]].push_back(indices[f + 2]);
+        neighbours[indices[f + 2]].push_back(indices[f    ]);
+    }
+
+    adjacencyOffsets.reserve(vertices.size() + 1);
+    for (const auto& vertexNeighbours: neighbours) {
+        adjacencyOffsets.push_back(static_cast<uint32_t>(adjacency.size()));
+        adjacency.insert(adjacency.end(), vertexNeighbours.begin(), vertexNeighbours.end());
+    }
+    adjacencyOffsets.push_back(static_cast<uint32_t>(adjacency.size()));
+
+    return true;
+}
+
+uint32_t ConvexHull::hillClimb(glm::vec3 direction, uint32_t startVertex) const {
+    uint32_t current = startVertex;
+    float currentDistance = glm::dot(direction, vertices[current]);
+
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        for (uint32_t i = adjacencyOffsets[current]; i < adjacencyOffsets[current + 1]; ++i) {
+            uint32_t neighbour = adjacency[i];
+            float distance = glm::dot(direction, vertices[neighbour]);
+            if (distance > currentDistance) {
+                current = neighbour;
+                currentDistance = distance;
+                moved = true;
+                break;
+            }
+        }
+    }
+
+    return current;
+}
@@ -9,13 +9,191 @@
  */
 
 #include <algorithm>
+#include <typeinfo>
 #include "../GJKCollisionEngine.h"
+#include "../SupportFunctions.h"
 #include <glm/gtx/string_cast.hpp>
 #include "Utils/Logger.h"
 
 const static glm::vec3 ORIGIN = glm::vec3(0);
 
-GJKState GJKCollisionEngine::testSimplex(std::vector<glm::vec3>& points, glm::vec3& direction) const {
+namespace {
+    /**
+     * A point on the Minkowski difference, with the points on each collider it came from
+     */
+    struct DistanceVertex {
+        glm::vec3 point;
+        glm::vec3 point1;
+        glm::vec3 point2;
+    };
+
+    /**
+     * A simplex for the GJK distance query, with the weight of each vertex in the point closest to the origin
+     */
+    struct DistanceSimplex {
+        std::array<DistanceVertex, 4> vertices;
+        std::array<float, 4> weights;
+        size_t count = 0;
+
+        /**
+         * Replace the simplex with some of its vertices
+         * @param indices The indices of the vertices to keep
+         * @param newWeights The weight of each kept vertex
+         * @param newCount The number of vertices to keep
+         */
+        void keep(const size_t* indices, const float* newWeights, size_t newCount) {
+            std::array<DistanceVertex, 4> kept;
+            for (size_t i = 0; i < newCount; ++i) {
+                kept[i] = vertices[indices[i]];
+                weights[i] = newWeights[i];
+            }
+            for (size_t i = 0; i < newCount; ++i) {
+                vertices[i] = kept[i];
+            }
+            count = newCount;
+        }
+
+        [[nodiscard]] glm::vec3 getClosestPoint() const {
+            glm::vec3 closest(0);
+            for (size_t i = 0; i < count; ++i) {
+                closest += vertices[i].point * weights[i];
+            }
+            return closest;
+        }
+    };
+
+    /**
+     * Reduce the simplex to the vertices of the segment ab closest to the origin
+     */
+    void closestOnSegment(DistanceSimplex& simplex, size_t a, size_t b) {
+        glm::vec3 pa = simplex.vertices[a].point;
+        glm::vec3 ab = simplex.vertices[b].point - pa;
+
+        float lengthSquared = glm::dot(ab, ab);
+        float t = lengthSquared > 0.f ? -glm::dot(pa, ab) / lengthSquared : 0.f;
+
+        if (t <= 0.f) {
+            const float weight = 1;
+            simplex.keep(&a, &weight, 1);
+        } else if (t >= 1.f) {
+            const float weight = 1;
+            simplex.keep(&b, &weight, 1);
+        } else {
+            const size_t indices[] = {a, b};
+            const float weights[] = {1 - t, t};
+            simplex.keep(indices, weights, 2);
+        }
+    }
+
+    /**
+     * Reduce the simplex to the vertices of the triangle abc closest to the origin
+     * Follows the Voronoi regions of the triangle, from Real-Time Collision Detection by Christer Ericson
+     */
+    void closestOnTriangle(DistanceSimplex& simplex, size_t a, size_t b, size_t c) {
+        glm::vec3 pa = simplex.vertices[a].point;
+        glm::vec3 pb = simplex.vertices[b].point;
+        glm::vec3 pc = simplex.vertices[c].point;
+        glm::vec3 ab = pb - pa;
+        glm::vec3 ac = pc - pa;
+
+        float d1 = glm::dot(ab, -pa);
+        float d2 = glm::dot(ac, -pa);
+        if (d1 <= 0.f && d2 <= 0.f) {
+            const float weight = 1;
+            simplex.keep(&a, &weight, 1);
+            return;
+        }
+
+        float d3 = glm::dot(ab, -pb);
+        float d4 = glm::dot(ac, -pb);
+        if (d3 >= 0.f && d4 <= d3) {
+            const float weight = 1;
+            simplex.keep(&b, &weight, 1);
+            return;
+        }
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+            closestOnSegment(simplex, a, b);
+            return;
+        }
+
+        float d5 = glm::dot(ab, -pc);
+        float d6 = glm::dot(ac, -pc);
+        if (d6 >= 0.f && d5 <= d6) {
+            const float weight = 1;
+            simplex.keep(&c, &weight, 1);
+            return;
+        }
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+            closestOnSegment(simplex, a, c);
+            return;
+        }
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+            closestOnSegment(simplex, b, c);
+            return;
+        }
+
+        // A flat triangle has no face region, so fall back to its longest edge
+        float total = va + vb + vc;
+        if (total <= 0.f) {
+            closestOnSegment(simplex, a, glm::dot(ab, ab) > glm::dot(ac, ac) ? b : c);
+            return;
+        }
+
+        const size_t indices[] = {a, b, c};
+        const float weights[] = {va / total, vb / total, vc / total};
+        simplex.keep(indices, weights, 3);
+    }
+
+    /**
+     * Reduce the simplex to the vertices of the tetrahedron closest to the origin
+     * @return false if the origin is inside the tetrahedron
+     */
+    bool closestOnTetrahedron(DistanceSimplex& simplex) {
+        // Each face with the vertex opposite it
+        const size_t faces[4][4] = {
+                {0, 1, 2, 3},
+                {0, 2, 3, 1},
+                {0, 3, 1, 2},
+                {1, 3, 2, 0}
+        };
+
+        bool outside = false;
+        DistanceSimplex closest;
+        float closestDistance = std::numeric_limits<float>::max();
+        for (const auto& face: faces) {
+            glm::vec3 pa = simplex.vertices[face[0]].point;
+            glm::vec3 normal = glm::cross(simplex.vertices[face[1]].point - pa, simplex.vertices[face[2]].point - pa);
+            float originSide = glm::dot(normal, -pa);
+            float oppositeSide = glm::dot(normal, simplex.vertices[face[3]].point - pa);
+
+            // A flat tetrahedron has no inside, so every face is checked
+            if (originSide * oppositeSide < 0.f || std::abs(oppositeSide) < 1e-9f) {
+                outside = true;
+
+                DistanceSimplex candidate = simplex;
+                closestOnTriangle(candidate, face[0], face[1], face[2]);
+                glm::vec3 point = candidate.getClosestPoint();
+                float distance = glm::dot(point, point);
+                if (distance < closestDistance) {
+                    closest = candidate;
+                    closestDistance = distance;
+                }
+            }
+        }
+
+        if (!outside) return false;
+        simplex = closest;
+        return true;
+    }
+}
+
+GJKState GJKCollisionEngine::testSimplex(Simplex& points, glm::vec3& direction) const {
     switch(points.size()) {
         case 2:
             return lineCase(points, direction);
@@ -28,7 +206,7 @@ GJKState GJKCollisionEngine::testSimplex(std::vector<glm::vec3>& points, glm::ve
     return GJKState::BUILDING;
 }
 
-GJKState GJKCollisionEngine::lineCase(std::vector<glm::vec3>& points, glm::vec3& direction) const {
+GJKState GJKCollisionEngine::lineCase(Simplex& points, glm::vec3& direction) const {
     glm::vec3 ab = points[0] - points[1];
     glm::vec3 a0 = - points[1];
 
@@ -56,7 +234,7 @@ GJKState GJKCollisionEngine::lineCase(std::vector<glm::vec3>& points, glm::vec3&
     return GJKState::BUILDING;
 }
 
-GJKState GJKCollisionEngine::triangleCase(std::vector<glm::vec3>& points, glm::vec3& direction) const {
+GJKState GJKCollisionEngine::triangleCase(Simplex& points, glm::vec3& direction) const {
     glm::vec3 ab = points[1] - points[2];
     glm::vec3 ac = points[0] - points[2];
     glm::vec3 a0 = - points[2];
@@ -72,7 +250,7 @@ GJKState GJKCollisionEngine::triangleCase(std::vector<glm::vec3>& points, glm::v
     return GJKState::BUILDING;
 }
 
-GJKState GJKCollisionEngine::simplexCase(std::vector<glm::vec3>& points, glm::vec3& direction) const {
+GJKState GJKCollisionEngine::simplexCase(Simplex& points, glm::vec3& direction) const {
     // Where a is the most recently added point
     glm::vec3 ab = points[2] - points[3];
     glm::vec3 ac = points[1] - points[3];
@@ -83,70 +261,254 @@ GJKState GJKCollisionEngine::simplexCase(std::vector<glm::vec3>& points, glm::ve
     glm::vec3 acdn = glm::cross(ac, ad);
     glm::vec3 adbn = glm::cross(ad, ab);
 
+    // Drop the point opposite the face the origin is in front of, keeping the order of the rest
     if (glm::dot(abcn, a0) > 0) {
-        points.erase(points.begin());
+        points.setTriangle(points[1], points[2], points[3]);
         return triangleCase(points, direction);
     } else if (glm::dot(acdn, a0) > 0) {
-        points.erase(points.begin() + 2);
+        points.setTriangle(points[0], points[1], points[3]);
         return triangleCase(points, direction);
     } else if (glm::dot(adbn, a0) > 0) {
-        points.erase(points.begin() + 1);
+        points.setTriangle(points[0], points[2], points[3]);
         return triangleCase(points, direction);
     }
 
     return GJKState::HIT;
 }
 
-glm::vec3 GJKCollisionEngine::getSupportPoint(Actor* actor1, Actor* actor2, glm::vec3 direction) const {
-    const Collider* a = actor1->actorCollider;
-    const Collider* b = actor2->actorCollider;
-
-    glm::vec3 aPos = a->findFurthestPointInDirection(direction) + a->getPosition();
-    glm::vec3 bPos = b->findFurthestPointInDirection(-direction) + b->getPosition();
-
-    return aPos - bPos;
+template<typename SupportA, typename SupportB>
+glm::vec3 GJKCollisionEngine::getSupportPoint(const SupportA& supportA, const SupportB& supportB, glm::vec3 direction) {
+    return supportA(direction) - supportB(-direction);
 }
 
-CollisionResult GJKCollisionEngine::testCollision(Actor* actor1, Actor* actor2) {
-     glm::vec3 direction = actor2->getPosition() - actor1->getPosition();
-    if (glm::dot(direction, direction) < 0.0001f) {
-        direction = {1, 0, 0};
+template<typename SupportA, typename SupportB>
+CollisionResult GJKCollisionEngine::gjk(const SupportA& supportA, const SupportB& supportB, glm::vec3& searchDirection, bool warmStarted, bool findPenetration) {
+    glm::vec3 direction = searchDirection;
+    // Written so a NaN direction isn't used either
+    if (!(glm::dot(direction, direction) >= 0.0001f)) {
+        warmStarted = false;
+        direction = supportB.position - supportA.position;
+        if (glm::dot(direction, direction) < 0.0001f) {
+            direction = {1, 0, 0};
+        }
+    }
+    Simplex simplex;
+    simplex.push_back(getSupportPoint(supportA, supportB, direction));
+    searchDirection = direction;
+
+    // Nothing is further along the direction than the origin, so the direction separates the colliders
+    if (glm::dot(simplex[0], direction) < 0) {
+        if (warmStarted) pairCache.countEarlyOut();
+        return CollisionResult{false};
     }
-    std::vector<glm::vec3> simplex = std::vector<glm::vec3>{
-            getSupportPoint(actor1, actor2, direction)
-    };
 
     // Return 0 if first point is very near the origin
     if (glm::dot(simplex[0], simplex[0]) < 0.001f) return CollisionResult{false};
 
-    simplex.reserve(4);
     direction = ORIGIN - simplex[0];
 
     // Max iteration count to catch infinite loops
     int i = 20;
     while (i > 0) {
-        glm::vec3 newPoint = getSupportPoint(actor1, actor2, direction);
+        glm::vec3 newPoint = getSupportPoint(supportA, supportB, direction);
+        searchDirection = direction;
         if (glm::dot(newPoint, direction) < 0) return CollisionResult{false};
 
         simplex.push_back(newPoint);
         GJKState state = testSimplex(simplex, direction);
-        if (state == GJKState::HIT) return this->epa(simplex, actor1, actor2);
-        else if (state == GJKState::MISS) return CollisionResult{false};
+        if (state == GJKState::HIT) {
+            if (!findPenetration) return CollisionResult{true, 0, glm::vec3(0)};
+
+            CollisionResult result = this->epa(simplex, supportA, supportB);
+            if (result.collided) searchDirection = result.normal;
+            return result;
+        } else if (state == GJKState::MISS) return CollisionResult{false};
         --i;
     }
     return CollisionResult{false};
 }
 
-size_t GJKCollisionEngine::getFaceNormals(std::vector<glm::vec3>& polytope, std::vector<size_t> indices,
-                                          std::vector<glm::vec4>& destNormals) const {
-    size_t minTriangle = 0;
+template<typename SupportA, typename SupportB>
+DistanceResult GJKCollisionEngine::gjkDistance(const SupportA& supportA, const SupportB& supportB) const {
+    auto getVertex = [&](glm::vec3 direction) {
+        glm::vec3 point1 = supportA(direction);
+        glm::vec3 point2 = supportB(-direction);
+        return DistanceVertex{point1 - point2, point1, point2};
+    };
+
+    glm::vec3 direction = supportB.position - supportA.position;
+    if (glm::dot(direction, direction) < 0.0001f) {
+        direction = {1, 0, 0};
+    }
+
+    DistanceSimplex simplex;
+    simplex.vertices[0] = getVertex(direction);
+    simplex.weights[0] = 1;
+    simplex.count = 1;
+    glm::vec3 closest = simplex.vertices[0].point;
+
+    // Max iteration count to catch the closest point never settling
+    for (int i = 0; i < 32; ++i) {
+        float distanceSquared = glm::dot(closest, closest);
+        if (distanceSquared < 1e-10f) return {true, 0, glm::vec3(0), glm::vec3(0)};
+
+        // Stop once the new support point doesn't get any closer to the origin than the current closest point
+        DistanceVertex vertex = getVertex(-closest);
+        if (distanceSquared - glm::dot(closest, vertex.point) <= 1e-5f * distanceSquared) break;
+
+        DistanceSimplex previous = simplex;
+        simplex.vertices[simplex.count++] = vertex;
+        switch (simplex.count) {
+            case 2:
+                closestOnSegment(simplex, 0, 1);
+                break;
+            case 3:
+                closestOnTriangle(simplex, 0, 1, 2);
+                break;
+            default:
+                if (!closestOnTetrahedron(simplex)) return {true, 0, glm::vec3(0), glm::vec3(0)};
+                break;
+        }
+
+        glm::vec3 newClosest = simplex.getClosestPoint();
+        // Rounding can stop the closest point getting any closer, in which case it is as close as it will get
+        if (glm::dot(newClosest, newClosest) >= distanceSquared) {
+            simplex = previous;
+            break;
+        }
+        closest = newClosest;
+    }
+
+    glm::vec3 closestPoint1(0), closestPoint2(0);
+    for (size_t i = 0; i < simplex.count; ++i) {
+        closestPoint1 += simplex.vertices[i].point1 * simplex.weights[i];
+        closestPoint2 += simplex.vertices[i].point2 * simplex.weights[i];
+    }
+
+    return {
+        false,
+        glm::length(closest),
+        closestPoint1,
+        closestPoint2
+    };
+}
+
+template<typename Function>
+auto GJKCollisionEngine::visitSupport(const Collider* collider, uint32_t& hint, Function&& function) {
+    switch (collider->colliderType) {
+        case ColliderType::AABB:
+            return function(AABBSupport(collider));
+        case ColliderType::SPHERE:
+            return function(SphereSupport(collider, hint));
+        case ColliderType::MESH:
+            // MeshCollider is the only built-in collider that can be extended, and its subclasses keep its type, so
+            // they are searched through their own findFurthestPointInDirection
+            if (typeid(*collider) != typeid(MeshCollider)) return function(ColliderSupport(collider));
+            return function(MeshSupport(collider, hint));
+        case ColliderType::OBB:
+            return function(OBBSupport(collider));
+        case ColliderType::CAPSULE:
+            return function(CapsuleSupport(collider));
+        default:
+            return function(ColliderSupport(collider));
+    }
+}
+
+CollisionResult GJKCollisionEngine::testCachedGJK(const Collider* collider1, const Collider* collider2, bool findPenetration) {
+    glm::vec3 direction(0);
+    uint32_t hint1 = 0, hint2 = 0;
+    bool warmStarted = pairCache.find(collider1->id, collider2->id, direction, hint1, hint2);
+
+    CollisionResult result = visitSupport(collider1, hint1, [&](const auto& supportA) {
+        return visitSupport(collider2, hint2, [&](const auto& supportB) {
+            return gjk(supportA, supportB, direction, warmStarted, findPenetration);
+        });
+    });
+
+    pairCache.store(collider1->id, collider2->id, direction, hint1, hint2);
+    return result;
+}
+
+CollisionResult GJKCollisionEngine::testGenericCollision(const Collider* collider1, const Collider* collider2) {
+    return testCachedGJK(collider1, collider2, true);
+}
+
+bool GJKCollisionEngine::testGenericIntersection(const Collider* collider1, const Collider* collider2) {
+    return testCachedGJK(collider1, collider2, false).collided;
+}
+
+DistanceResult GJKCollisionEngine::testGenericDistance(const Collider* collider1, const Collider* collider2) {
+    uint32_t hint1 = 0, hint2 = 0;
+    return visitSupport(collider1, hint1, [&](const auto& supportA) {
+        return visitSupport(collider2, hint2, [&](const auto& supportB) {
+            return gjkDistance(supportA, supportB);
+        });
+    });
+}
+
+CollisionResult GJKCollisionEngine::testGenericTriangles(const Triangle* triangles, size_t triangleCount, const Collider* collider, bool findPenetration) {
+    // The triangles are close together, so the hint carries over from one to the next
+    uint32_t hint = 0;
+    return visitSupport(collider, hint, [&](const auto& support) {
+        CollisionResult deepest = {false, 0, glm::vec3(0)};
+        for (size_t i = 0; i < triangleCount; ++i) {
+            glm::vec3 direction(0);
+            CollisionResult result = gjk(TriangleSupport(triangles[i]), support, direction, false, findPenetration);
+            if (result.collided && !findPenetration) return result;
+            if (result.collided && (!deepest.collided || result.depth > deepest.depth)) deepest = result;
+        }
+        return deepest;
+    });
+}
+
+DistanceResult GJKCollisionEngine::testGenericTriangleDistance(const Triangle& triangle, const Collider* collider) {
+    uint32_t hint = 0;
+    return visitSupport(collider, hint, [&](const auto& support) {
+        return gjkDistance(TriangleSupport(triangle), support);
+    });
+}
+
+void GJKCollisionEngine::testCollisions(const std::vector<std::pair<Actor*, Actor*>>& pairs, std::vector<CollisionResult>& destResults, ThreadPool& threadPool) {
+    CollisionEngine::testCollisions(pairs, destResults, threadPool);
+    pairCacheStats = pairCache.expire();
+}
+
+EPAScratch::EPAScratch() {
+    for (auto& row: edgeHeads) {
+        row.fill(-1);
+    }
+    for (auto& row: edgeTails) {
+        row.fill(-1);
+    }
+}
+
+void EPAScratch::reset(const Simplex& simplex) {
+    for (size_t i = 0; i < 4; ++i) {
+        points[i] = simplex[i];
+    }
+    pointCount = 4;
+
+    // create indices to denote the faces of the polytope
+    const uint32_t tetrahedron[] = {
+            0, 1, 2,
+            0, 3, 1,
+            0, 2, 3,
+            1, 3, 2
+    };
+    std::copy(std::begin(tetrahedron), std::end(tetrahedron), indices.begin());
+    faceCount = 4;
+    edgeCount = 0;
+}
+
+size_t GJKCollisionEngine::getFaceNormals(EPAScratch& scratch, size_t firstFace) const {
+    size_t minTriangle = firstFace;
     float minDistance = std::numeric_limits<float>::max();
 
-    for (size_t i = 0; i * 3 < indices.size(); ++i) {
+    for (size_t i = firstFace; i < scratch.faceCount; ++i) {
         size_t I = i * 3;
-        glm::vec3 a = polytope[indices[I  ]];
-        glm::vec3 b = polytope[indices[I + 1]];
-        glm::vec3 c = polytope[indices[I + 2]];
+        glm::vec3 a = scratch.points[scratch.indices[I  ]];
+        glm::vec3 b = scratch.points[scratch.indices[I + 1]];
+        glm::vec3 c = scratch.points[scratch.indices[I + 2]];
 
         glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
         float distance = glm::dot(normal, a);
@@ -155,50 +517,57 @@ size_t GJKCollisionEngine::getFaceNormals(std::vector<glm::vec3>& polytope, std:
             distance *= -1;
         }
 
-        destNormals.emplace_back(normal, distance);
+        scratch.normals[i] = glm::vec4(normal, distance);
 
         if (distance < minDistance) {
-            minTriangle = I;
+            minTriangle = i;
             minDistance = distance;
         }
     }
     return minTriangle;
 }
 
-void GJKCollisionEngine::addIfUniqueEdge(std::vector<size_t>& indices, size_t edgeIndexA, size_t edgeIndexB,
-                                         std::vector<std::pair<size_t, size_t>>& destEdges) const {
-    auto reverse = std::find(destEdges.begin(), destEdges.end(), std::make_pair(indices[edgeIndexB], indices[edgeIndexA]));
+bool GJKCollisionEngine::addIfUniqueEdge(EPAScratch& scratch, uint32_t a, uint32_t b) const {
+    // If the reverse is already there, the face on the other side was removed too, so it isn't on the horizon
+    int16_t reverse = scratch.edgeHeads[b][a];
+    if (reverse >= 0) {
+        EPAScratch::Edge& reverseEdge = scratch.edges[reverse];
+        reverseEdge.unique = false;
+        scratch.edgeHeads[b][a] = reverseEdge.next;
+        return true;
+    }
 
-    if (reverse != destEdges.end()) destEdges.erase(reverse);
-    else destEdges.emplace_back(indices[edgeIndexA], indices[edgeIndexB]);
+    if (scratch.edgeCount == EPAScratch::MAX_EDGES) return false;
+    auto index = static_cast<int16_t>(scratch.edgeCount++);
+    scratch.edges[index] = {static_cast<uint8_t>(a), static_cast<uint8_t>(b), true, -1};
+
+    // Degenerate polytopes can have the same edge more than once, keep them in order
+    if (scratch.edgeHeads[a][b] < 0) scratch.edgeHeads[a][b] = index;
+    else scratch.edges[scratch.edgeTails[a][b]].next = index;
+    scratch.edgeTails[a][b] = index;
+    return true;
 }
 
-CollisionResult GJKCollisionEngine::epa(std::vector<glm::vec3>& polytope, Actor* actor1, Actor* actor2) const {
-    // create indices to denote the faces of the polytope
-    std::vector<size_t> indices = {
-            0, 1, 2,
-            0, 3, 1,
-            0, 2, 3,
-            1, 3, 2
-    };
+template<typename SupportA, typename SupportB>
+CollisionResult GJKCollisionEngine::epa(const Simplex& simplex, const SupportA& supportA, const SupportB& supportB) const {
+    thread_local EPAScratch scratch;
+    scratch.reset(simplex);
 
     // Calculate the normals of the existing faces
-    // Normal and distance packed into vec4 to avoid making a one-off structure
-    std::vector<glm::vec4> normals;
-    size_t minIndex = getFaceNormals(polytope, indices, normals);
+    size_t minIndex = getFaceNormals(scratch, 0);
 
     glm::vec3 minNormal;
     float minDistance = std::numeric_limits<float>::max();
 
     while (minDistance == std::numeric_limits<float>::max()) {
-        if (polytope.size() > 30) {
+        if (scratch.pointCount > 30 || scratch.faceCount == 0) {
             return {false};
         }
-        minNormal = glm::vec3(normals[minIndex]);
-        minDistance = normals[minIndex].w;
+        minNormal = glm::vec3(scratch.normals[minIndex]);
+        minDistance = scratch.normals[minIndex].w;
 
         // Calculate a new support point from the normal with the shortest distance
-        glm::vec3 newPoint = getSupportPoint(actor1, actor2, minNormal);
+        glm::vec3 newPoint = getSupportPoint(supportA, supportB, minNormal);
         float sDistance = glm::dot(minNormal, newPoint);
 
         // If the distance isn't the same (within a margin), add the new point to the polytope and repair the faces
@@ -206,58 +575,66 @@ CollisionResult GJKCollisionEngine::epa(std::vector<glm::vec3>& polytope, Actor*
             minDistance = std::numeric_limits<float>::max();
 
             // Iterate through the normals and remove all the faces whose edges are in the same direction as the support point
-            std::vector<std::pair<size_t, size_t>> uniqueEdges;
-            for (size_t i = 0; i < normals.size(); ++i) {
-                if (glm::dot(glm::vec3(normals[i]), newPoint) > 0) {
+            bool edgesFull = false;
+            scratch.edgeCount = 0;
+            for (size_t i = 0; i < scratch.faceCount; ++i) {
+                if (glm::dot(glm::vec3(scratch.normals[i]), newPoint) > 0) {
                     size_t f = i * 3;
-                    addIfUniqueEdge(indices, f, f + 1, uniqueEdges);
-                    addIfUniqueEdge(indices, f + 1, f + 2, uniqueEdges);
-                    addIfUniqueEdge(indices, f + 2, f, uniqueEdges);
+                    edgesFull |= !addIfUniqueEdge(scratch, scratch.indices[f    ], scratch.indices[f + 1]);
+                    edgesFull |= !addIfUniqueEdge(scratch, scratch.indices[f + 1], scratch.indices[f + 2]);
+                    edgesFull |= !addIfUniqueEdge(scratch, scratch.indices[f + 2], scratch.indices[f    ]);
 
-                    // Replace face with back and pop back, avoids slowdowns by shuffling the whole rest of the vector down
-                    indices[f + 2] = indices.back();
-                    indices.pop_back();
-                    indices[f + 1] = indices.back();
-                    indices.pop_back();
-                    indices[f] = indices.back();
-                    indices.pop_back();
-
-                    normals[i] = normals.back();
-                    normals.pop_back();
+                    // Replace face with back, avoids slowdowns by shuffling the whole rest of the faces down
+                    size_t back = (--scratch.faceCount) * 3;
+                    scratch.indices[f    ] = scratch.indices[back    ];
+                    scratch.indices[f + 1] = scratch.indices[back + 1];
+                    scratch.indices[f + 2] = scratch.indices[back + 2];
+                    scratch.normals[i] = scratch.normals[scratch.faceCount];
 
                     // Decrement so we check this index again
                     --i;
                 }
             }
 
-            // Use the unique edges to build new faces
-            std::vector<size_t> newIndices;
-            for (auto& edge: uniqueEdges) {
-                newIndices.push_back(edge.first);
-                newIndices.push_back(edge.second);
-                newIndices.push_back(polytope.size());
+            // Use the unique edges to build new faces, clearing the edge lookup as we go
+            size_t firstNewFace = scratch.faceCount;
+            auto newPointIndex = static_cast<uint32_t>(scratch.pointCount);
+            bool facesFull = false;
+            for (size_t i = 0; i < scratch.edgeCount; ++i) {
+                const EPAScratch::Edge& edge = scratch.edges[i];
+                scratch.edgeHeads[edge.a][edge.b] = -1;
+                scratch.edgeTails[edge.a][edge.b] = -1;
+                if (!edge.unique) continue;
+                if (scratch.faceCount == EPAScratch::MAX_FACES) {
+                    facesFull = true;
+                    continue;
+                }
+
+                size_t f = (scratch.faceCount++) * 3;
+                scratch.indices[f    ] = edge.a;
+                scratch.indices[f + 1] = edge.b;
+                scratch.indices[f + 2] = newPointIndex;
             }
-            polytope.push_back(newPoint);
+            scratch.points[scratch.pointCount++] = newPoint;
+
+            // The polytope is only this complex with degenerate input, give up like when there are too many points
+            if (edgesFull || facesFull) return {false};
 
             // Calculate the normals for the new faces
-            std::vector<glm::vec4> newNormals;
-            size_t newMinIndex = getFaceNormals(polytope, newIndices, newNormals);
+            size_t newMinIndex = getFaceNormals(scratch, firstNewFace);
 
             float oldMinDistance = std::numeric_limits<float>::max();
-            for (size_t i = 0; i < normals.size(); ++i) {
-                if (normals[i].w < oldMinDistance) {
-                    oldMinDistance = normals[i].w;
+            for (size_t i = 0; i < firstNewFace; ++i) {
+                if (scratch.normals[i].w < oldMinDistance) {
+                    oldMinDistance = scratch.normals[i].w;
                     minIndex = i;
                 }
             }
 
             // If the new normal is further, update the min face
-            if (newNormals[newMinIndex].w < oldMinDistance) {
-                minIndex = newMinIndex + normals.size();
+            if (newMinIndex < scratch.faceCount && scratch.normals[newMinIndex].w < oldMinDistance) {
+                minIndex = newMinIndex;
             }
-
-            indices.insert(indices.end(), newIndices.begin(), newIndices.end());
-            normals.insert(normals.end(), newNormals.begin(), newNormals.end());
         }
     }
 
@@ -266,4 +643,4 @@ CollisionResult GJKCollisionEngine::epa(std::vector<glm::vec3>& polytope, Actor*
         minDistance + 0.001f,
         minNormal
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,83 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/GJKPairCache.h"
+
+#include <utility>
+
+uint64_t GJKPairCache::getKey(uint32_t id1, uint32_t id2, bool& destFlipped) {
+    destFlipped = id1 > id2;
+    if (destFlipped) std::swap(id1, id2);
+
+    return (static_cast<uint64_t>(id1) << 32) | id2;
+}
+
+GJKPairCache::Shard& GJKPairCache::getShard(uint64_t key) {
+    // Mix both ids into the shard index, pairs sharing a collider would all land in the same shard otherwise
+    return shards[((key >> 32) ^ (key * 0x9E3779B97F4A7C15ull >> 40)) % SHARD_COUNT];
+}
+
+bool GJKPairCache::find(uint32_t id1, uint32_t id2, glm::vec3& destDirection, uint32_t& destHint1, uint32_t& destHint2) {
+    bool flipped;
+    uint64_t key = getKey(id1, id2, flipped);
+    Shard& shard = getShard(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto entry = shard.entries.find(key);
+    if (entry == shard.entries.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    hits.fetch_add(1, std::memory_order_relaxed);
+    entry->second.lastUsed = generation;
+    destDirection = flipped ? -entry->second.direction : entry->second.direction;
+    destHint1 = entry->second.hints[flipped ? 1 : 0];
+    destHint2 = entry->second.hints[flipped ? 0 : 1];
+    return true;
+}
+
+void GJKPairCache::store(uint32_t id1, uint32_t id2, glm::vec3 direction, uint32_t hint1, uint32_t hint2) {
+    bool flipped;
+    uint64_t key = getKey(id1, id2, flipped);
+    Shard& shard = getShard(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (flipped) {
+        shard.entries[key] = {-direction, {hint2, hint1}, generation};
+    } else {
+        shard.entries[key] = {direction, {hint1, hint2}, generation};
+    }
+}
+
+void GJKPairCache::countEarlyOut() {
+    earlyOuts.fetch_add(1, std::memory_order_relaxed);
+}
+
+PairCacheStats GJKPairCache::expire() {
+    PairCacheStats stats;
+    stats.hits = hits.exchange(0, std::memory_order_relaxed);
+    stats.misses = misses.exchange(0, std::memory_order_relaxed);
+    stats.earlyOuts = earlyOuts.exchange(0, std::memory_order_relaxed);
+
+    for (Shard& shard: shards) {
+        for (auto entry = shard.entries.begin(); entry != shard.entries.end();) {
+            if (entry->second.lastUsed != generation) {
+                entry = shard.entries.erase(entry);
+                ++stats.expired;
+            } else {
+                ++entry;
+            }
+        }
+    }
+
+    ++generation;
+    return stats;
+}
+
+void GJKPairCache::clear() {
+    for (Shard& shard: shards) {
+        shard.entries.clear();
+    }
+}
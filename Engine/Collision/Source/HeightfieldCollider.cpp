@@ -0,0 +1,221 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/HeightfieldCollider.h"
+
+#include <Utils/Logger.h>
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#define HEIGHTFIELDVERSION 1
+
+HeightfieldCollider::HeightfieldCollider(CollisionMode collisionMode, uint32_t columns, uint32_t rows, float spacing, const std::vector<float>& heights)
+        : Collider(collisionMode, ColliderType::HEIGHTFIELD), columns(columns), rows(rows), spacing(spacing) {
+    if (static_cast<uint64_t>(columns) * rows != heights.size() || !(spacing > 0)) {
+        Logger::warn("Heightfield collider needs a positive spacing and a height for every point of the grid");
+        this->columns = 0;
+        this->rows = 0;
+        return;
+    }
+    setHeights(heights);
+}
+
+void HeightfieldCollider::setHeights(const std::vector<float>& newHeights) {
+    float lowest = std::numeric_limits<float>::max();
+    float highest = -std::numeric_limits<float>::max();
+    for (float height: newHeights) {
+        lowest = std::min(lowest, height);
+        highest = std::max(highest, height);
+    }
+    heightOffset = newHeights.empty() ? 0 : lowest;
+    heightScale = newHeights.empty() ? 0 : (highest - lowest) / std::numeric_limits<uint16_t>::max();
+
+    heights.resize(newHeights.size());
+    for (size_t i = 0; i < newHeights.size(); ++i) {
+        float step = heightScale > 0 ? (newHeights[i] - heightOffset) / heightScale : 0;
+        heights[i] = static_cast<uint16_t>(std::min(step + .5f, static_cast<float>(std::numeric_limits<uint16_t>::max())));
+    }
+    buildLevels();
+}
+
+void HeightfieldCollider::buildLevels() {
+    levels.clear();
+    if (columns < 2 || rows < 2) return;
+
+    // Each chunk of the finest level takes the heights around its cells, so the heights on its edges are also in the
+    // chunks next to it
+    Level finest{(columns - 2) / CHUNK_SIZE + 1, (rows - 2) / CHUNK_SIZE + 1, {}};
+    finest.ranges.resize(static_cast<size_t>(finest.chunksX) * finest.chunksZ, {std::numeric_limits<uint16_t>::max(), 0});
+    for (uint32_t chunkZ = 0; chunkZ < finest.chunksZ; ++chunkZ) {
+        for (uint32_t chunkX = 0; chunkX < finest.chunksX; ++chunkX) {
+            HeightRange& range = finest.ranges[static_cast<size_t>(chunkZ) * finest.chunksX + chunkX];
+            uint32_t endZ = std::min(chunkZ * CHUNK_SIZE + CHUNK_SIZE, rows - 1);
+            uint32_t endX = std::min(chunkX * CHUNK_SIZE + CHUNK_SIZE, columns - 1);
+            for (uint32_t z = chunkZ * CHUNK_SIZE; z <= endZ; ++z) {
+                for (uint32_t x = chunkX * CHUNK_SIZE; x <= endX; ++x) {
+                    uint16_t height = heights[static_cast<size_t>(z) * columns + x];
+                    range.min = std::min(range.min, height);
+                    range.max = std::max(range.max, height);
+                }
+            }
+        }
+    }
+    levels.push_back(std::move(finest));
+
+    // Each level above covers four chunks of the one below it, until a single chunk covers the whole grid
+    while (levels.back().chunksX > 1 || levels.back().chunksZ > 1) {
+        const Level& below = levels.back();
+        Level level{(below.chunksX + 1) / 2, (below.chunksZ + 1) / 2, {}};
+        level.ranges.resize(static_cast<size_t>(level.chunksX) * level.chunksZ, {std::numeric_limits<uint16_t>::max(), 0});
+        for (uint32_t z = 0; z < below.chunksZ; ++z) {
+            for (uint32_t x = 0; x < below.chunksX; ++x) {
+                const HeightRange& child = below.ranges[static_cast<size_t>(z) * below.chunksX + x];
+                HeightRange& range = level.ranges[static_cast<size_t>(z / 2) * level.chunksX + x / 2];
+                range.min = std::min(range.min, child.min);
+                range.max = std::max(range.max, child.max);
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+
+    // The grid changed, so the mesh drawn for it is made again when it is next needed
+    renderMesh = Mesh();
+}
+
+bool HeightfieldCollider::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        Logger::warn("Failed to save heightfield collider at " + filePath);
+        return false;
+    }
+
+    uint8_t version = HEIGHTFIELDVERSION;
+    file.write(reinterpret_cast<const char*>(&version), 1);
+    file.write(reinterpret_cast<const char*>(&columns), 4);
+    file.write(reinterpret_cast<const char*>(&rows), 4);
+    file.write(reinterpret_cast<const char*>(&spacing), 4);
+    file.write(reinterpret_cast<const char*>(&heightScale), 4);
+    file.write(reinterpret_cast<const char*>(&heightOffset), 4);
+    file.write(reinterpret_cast<const char*>(heights.data()), heights.size() * sizeof(uint16_t));
+
+    file.close();
+    return true;
+}
+
+bool HeightfieldCollider::loadFromFile(const std::string& filePath) {
+    if (!std::filesystem::exists(filePath)) {
+        Logger::warn("Failed to load heightfield collider at " + filePath);
+        return false;
+    }
+    std::ifstream file(filePath, std::ios::binary);
+    uint8_t version;
+    uint32_t newColumns, newRows;
+    float newSpacing, newHeightScale, newHeightOffset;
+    file.read(reinterpret_cast<char*>(&version), 1);
+    if (version != HEIGHTFIELDVERSION) {
+        Logger::warn("Incorrect version of heightfield collider standard, this file cannot be read");
+        file.close();
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&newColumns), 4);
+    file.read(reinterpret_cast<char*>(&newRows), 4);
+    file.read(reinterpret_cast<char*>(&newSpacing), 4);
+    file.read(reinterpret_cast<char*>(&newHeightScale), 4);
+    file.read(reinterpret_cast<char*>(&newHeightOffset), 4);
+    uintmax_t heightCount = static_cast<uintmax_t>(newColumns) * newRows;
+    if (!file || !(newSpacing > 0) || !std::isfinite(newHeightScale) || !std::isfinite(newHeightOffset)
+        || std::filesystem::file_size(filePath) < 21 + heightCount * sizeof(uint16_t)) {
+        Logger::warn("Heightfield collider at " + filePath + " is corrupt");
+        file.close();
+        return false;
+    }
+
+    std::vector<uint16_t> newHeights(heightCount);
+    file.read(reinterpret_cast<char*>(newHeights.data()), newHeights.size() * sizeof(uint16_t));
+    bool valid = static_cast<bool>(file);
+    file.close();
+    if (!valid) {
+        Logger::warn("Heightfield collider at " + filePath + " is corrupt");
+        return false;
+    }
+
+    columns = newColumns;
+    rows = newRows;
+    spacing = newSpacing;
+    heightScale = newHeightScale;
+    heightOffset = newHeightOffset;
+    heights = std::move(newHeights);
+    buildLevels();
+    return true;
+}
+
+size_t HeightfieldCollider::getTriangleCount() const {
+    if (columns < 2 || rows < 2) return 0;
+    return static_cast<size_t>(columns - 1) * (rows - 1) * 2;
+}
+
+BoundingBox HeightfieldCollider::getBoundingBox() const {
+    if (levels.empty()) return {glm::vec3(0), glm::vec3(0)};
+
+    const HeightRange& range = levels.back().ranges[0];
+    glm::vec3 min(0, heightOffset + heightScale * range.min, 0);
+    glm::vec3 max(static_cast<float>(columns - 1) * spacing, heightOffset + heightScale * range.max, static_cast<float>(rows - 1) * spacing);
+    return BoundingBox(min, max).transformed(glm::mat3(getTransform()));
+}
+
+glm::vec3 HeightfieldCollider::findFurthestPointInDirection(glm::vec3 direction) const {
+    if (levels.empty()) return glm::vec3(0);
+
+    const HeightRange& range = levels.back().ranges[0];
+    glm::vec3 min(0, heightOffset + heightScale * range.min, 0);
+    glm::vec3 max(static_cast<float>(columns - 1) * spacing, heightOffset + heightScale * range.max, static_cast<float>(rows - 1) * spacing);
+    glm::mat3 toWorld(getTransform());
+
+    // The furthest corner of a box is on the side of each of its axes the direction points along
+    glm::vec3 localDirection = glm::transpose(toWorld) * direction;
+    glm::vec3 corner(localDirection.x > 0 ? max.x : min.x, localDirection.y > 0 ? max.y : min.y, localDirection.z > 0 ? max.z : min.z);
+    return toWorld * corner;
+}
+
+Mesh* HeightfieldCollider::getRenderMesh() {
+    if (!renderMesh.vertices.empty() || levels.empty()) return &renderMesh;
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(heights.size());
+    for (uint32_t z = 0; z < rows; ++z) {
+        for (uint32_t x = 0; x < columns; ++x) {
+            // The normal is found from the slope between the neighbouring heights
+            float slopeX = getHeight(std::min(x + 1, columns - 1), z) - getHeight(x > 0 ? x - 1 : 0, z);
+            float slopeZ = getHeight(x, std::min(z + 1, rows - 1)) - getHeight(x, z > 0 ? z - 1 : 0);
+            glm::vec3 normal = glm::normalize(glm::vec3(-slopeX, 2 * spacing, -slopeZ));
+            glm::vec2 uv(static_cast<float>(x) / static_cast<float>(columns - 1), static_cast<float>(z) / static_cast<float>(rows - 1));
+            vertices.emplace_back(glm::vec3(static_cast<float>(x) * spacing, getHeight(x, z), static_cast<float>(z) * spacing),
+                                  normal, glm::vec3(1, 0, 0), glm::vec3(1), uv);
+        }
+    }
+
+    // The same triangles as queryTriangles
+    std::vector<uint32_t> indices;
+    indices.reserve(getTriangleCount() * 3);
+    for (uint32_t z = 0; z + 1 < rows; ++z) {
+        for (uint32_t x = 0; x + 1 < columns; ++x) {
+            uint32_t corner00 = z * columns + x;
+            uint32_t corner10 = corner00 + 1;
+            uint32_t corner01 = corner00 + columns;
+            uint32_t corner11 = corner01 + 1;
+            indices.insert(indices.end(), {corner00, corner01, corner10, corner10, corner01, corner11});
+        }
+    }
+
+    renderMesh = Mesh(std::move(vertices), std::move(indices));
+    return &renderMesh;
+}
+
+glm::mat4 HeightfieldCollider::getRenderMeshTransform() {
+    return getTransform();
+}
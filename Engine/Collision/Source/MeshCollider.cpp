@@ -5,24 +5,38 @@
 #include <glm/geometric.hpp>
 #include "Collision/MeshCollider.h"
 
-MeshCollider::MeshCollider(CollisionMode collisionMode, Mesh* mesh) : Collider(collisionMode), mesh(mesh) {}
+MeshCollider::MeshCollider(CollisionMode collisionMode, Mesh* mesh) : MeshCollider(collisionMode, mesh, ColliderType::MESH) {}
 
-BoundingBox MeshCollider::getBoundingBox() {
+MeshCollider::MeshCollider(CollisionMode collisionMode, Mesh* mesh, ColliderType colliderType) : Collider(collisionMode, colliderType), mesh(mesh) {
+    if (mesh == nullptr) return;
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(mesh->vertices.size());
+    for (const Vertex& vertex: mesh->vertices) {
+        positions.push_back(vertex.position);
+    }
+
+    // Flat meshes have no hull to walk, so are searched instead
+    if (!hull.build(positions)) supportPoints = SupportPointCloud(positions);
+}
+
+BoundingBox MeshCollider::getBoundingBox() const {
     return mesh->boundingBox;
 }
 
 glm::vec3 MeshCollider::findFurthestPointInDirection(glm::vec3 direction) const {
-    int maxVert = 0;
-    float maxDistance = glm::dot(direction, mesh->vertices.at(0).position);
-    for (int i = 1; i < mesh->vertices.size(); ++i) {
-        glm::vec3& vertex = mesh->vertices.at(i).position;
-        float distance = glm::dot(direction, vertex);
-        if (distance > maxDistance) {
-            maxDistance = distance;
-            maxVert = i;
-        }
+    uint32_t hint = 0;
+    return findFurthestPointInDirection(direction, hint);
+}
+
+glm::vec3 MeshCollider::findFurthestPointInDirection(glm::vec3 direction, uint32_t& hint) const {
+    if (!hull.vertices.empty()) {
+        hint = hull.hillClimb(direction, hint);
+        return hull.vertices[hint];
     }
-    return mesh->vertices.at(maxVert).position;
+
+    if (supportPoints.size() == 0) return glm::vec3(0);
+    return supportPoints.getPoint(supportPoints.findFurthestPointIndex(direction));
 }
 
 Mesh* MeshCollider::getRenderMesh() {
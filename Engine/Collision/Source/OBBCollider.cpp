@@ -0,0 +1,75 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/OBBCollider.h"
+#include "Utils/FileUtils.h"
+
+#include <glm/glm.hpp>
+
+Mesh* OBBCollider::renderMesh = Mesh::createNewMeshFromFile(FileUtils::getAssetsPath() + "/Shapes/Cube.lmesh");
+
+glm::vec3 OrientedBox::getFurthestPoint(glm::vec3 direction) const {
+    glm::vec3 point = centre;
+    for (int i = 0; i < 3; ++i) {
+        point += axes[i] * (glm::dot(direction, axes[i]) > 0 ? halfExtents[i] : -halfExtents[i]);
+    }
+    return point;
+}
+
+OBBCollider::OBBCollider(CollisionMode collisionMode, const BoundingBox& boundingBox) : Collider(collisionMode, ColliderType::OBB), boundingBox(boundingBox) {}
+
+OBBCollider::OBBCollider(CollisionMode collisionMode, glm::vec3 min, glm::vec3 max) : Collider(collisionMode, ColliderType::OBB), boundingBox(min, max) {}
+
+BoundingBox OBBCollider::getBoundingBox() const {
+    OrientedBox box = getWorldBox();
+    glm::vec3 position = getPosition();
+
+    // Each axis reaches out along each world axis by the length of its side in that direction
+    glm::vec3 extent(0);
+    for (int i = 0; i < 3; ++i) {
+        extent += glm::abs(box.axes[i]) * box.halfExtents[i];
+    }
+    return {box.centre - extent - position, box.centre + extent - position};
+}
+
+const BoundingBox& OBBCollider::getBox() const {
+    return boundingBox;
+}
+
+OrientedBox OBBCollider::getWorldBox() const {
+    glm::mat4 transform = getTransform();
+    glm::vec3 localCentre = (boundingBox.min + boundingBox.max) * .5f;
+    glm::vec3 localHalfExtents = (boundingBox.max - boundingBox.min) * .5f;
+
+    // The columns of the transform are the box's axes, scaled by the scale of the transform
+    OrientedBox box{};
+    box.centre = glm::vec3(transform * glm::vec4(localCentre, 1));
+    for (int i = 0; i < 3; ++i) {
+        glm::vec3 axis(transform[i]);
+        float length = glm::length(axis);
+        box.axes[i] = length > 0 ? axis / length : glm::vec3(i == 0, i == 1, i == 2);
+        box.halfExtents[i] = localHalfExtents[i] * length;
+    }
+    return box;
+}
+
+glm::vec3 OBBCollider::findFurthestPointInDirection(glm::vec3 direction) const {
+    return getWorldBox().getFurthestPoint(direction) - getPosition();
+}
+
+Mesh* OBBCollider::getRenderMesh() {
+    return OBBCollider::renderMesh;
+}
+
+glm::mat4 OBBCollider::getRenderMeshTransform() {
+    OrientedBox box = getWorldBox();
+
+    // The cube mesh is 1 across, so each axis is scaled to the full size of the box
+    glm::mat4 transform(1.f);
+    for (int i = 0; i < 3; ++i) {
+        transform[i] = glm::vec4(box.axes[i] * box.halfExtents[i] * 2.f, 0);
+    }
+    transform[3] = glm::vec4(box.centre, 1);
+    return transform;
+}
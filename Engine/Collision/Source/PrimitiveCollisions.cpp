@@ -0,0 +1,728 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/PrimitiveCollisions.h"
+#include "Collision/SphereCollider.h"
+#include "Collision/AABBCollider.h"
+#include "Collision/OBBCollider.h"
+#include "Collision/CapsuleCollider.h"
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    /**
+     * Test two oriented boxes with the separating axis test
+     * @return The collision, with the normal pointing from the first box towards the second
+     */
+    CollisionResult boxBox(const OrientedBox& box1, const OrientedBox& box2) {
+        glm::vec3 offset = box2.centre - box1.centre;
+
+        float minDistance = std::numeric_limits<float>::max();
+        glm::vec3 normal(0);
+
+        // Returns false if the boxes are apart along the axis, otherwise keeps the axis if they overlap least along it
+        auto testAxis = [&](glm::vec3 axis) {
+            float radius1 = 0, radius2 = 0;
+            for (int i = 0; i < 3; ++i) {
+                radius1 += box1.halfExtents[i] * std::abs(glm::dot(box1.axes[i], axis));
+                radius2 += box2.halfExtents[i] * std::abs(glm::dot(box2.axes[i], axis));
+            }
+
+            float distance = glm::dot(offset, axis);
+            float overlap = radius1 + radius2 - std::abs(distance);
+            if (overlap <= 0.f) return false;
+
+            if (overlap < minDistance) {
+                minDistance = overlap;
+                normal = distance >= 0.f ? axis : -axis;
+            }
+            return true;
+        };
+
+        // The faces are tested first, so they win ties with the edges
+        for (const glm::vec3& axis: box1.axes) {
+            if (!testAxis(axis)) return {false};
+        }
+        for (const glm::vec3& axis: box2.axes) {
+            if (!testAxis(axis)) return {false};
+        }
+
+        // Edges that are nearly parallel don't give an axis, and are already covered by the face axes
+        for (const glm::vec3& axis1: box1.axes) {
+            for (const glm::vec3& axis2: box2.axes) {
+                glm::vec3 axis = glm::cross(axis1, axis2);
+                float lengthSquared = glm::dot(axis, axis);
+                if (lengthSquared < 1e-6f) continue;
+                if (!testAxis(axis / std::sqrt(lengthSquared))) return {false};
+            }
+        }
+
+        return {
+            true,
+            minDistance + PrimitiveCollisions::COLLISION_MARGIN,
+            normal
+        };
+    }
+
+    /**
+     * Get an AABBCollider as an oriented box, AABBColliders don't rotate so its axes are the world axes
+     */
+    OrientedBox getAxisAlignedBox(const Collider* box) {
+        const BoundingBox& localBox = static_cast<const AABBCollider*>(box)->getBox();
+        return {
+            (localBox.min + localBox.max) * .5f + box->getPosition(),
+            {glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1)},
+            (localBox.max - localBox.min) * .5f
+        };
+    }
+
+    /**
+     * Get a unit vector at right angles to the given vector, used to push apart shapes whose centres meet
+     */
+    glm::vec3 getPerpendicular(glm::vec3 vector) {
+        glm::vec3 absolute = glm::abs(vector);
+        if (absolute.x + absolute.y + absolute.z < 0.0001f) return {1, 0, 0};
+
+        // Crossing with the axis the vector is least along can't give a zero vector
+        glm::vec3 axis = absolute.x <= absolute.y && absolute.x <= absolute.z ? glm::vec3(1, 0, 0)
+                       : absolute.y <= absolute.z ? glm::vec3(0, 1, 0) : glm::vec3(0, 0, 1);
+        return glm::normalize(glm::cross(vector, axis));
+    }
+
+    /**
+     * Find the point on a segment closest to a point
+     * @return How far along the segment the closest point is, between 0 and 1
+     */
+    float getClosestOnSegment(glm::vec3 start, glm::vec3 end, glm::vec3 point) {
+        glm::vec3 direction = end - start;
+        float lengthSquared = glm::dot(direction, direction);
+        if (lengthSquared <= 0.f) return 0.f;
+        return glm::clamp(glm::dot(point - start, direction) / lengthSquared, 0.f, 1.f);
+    }
+
+    /**
+     * Find the closest points of two segments
+     * @param closest1 Set to the point on the first segment closest to the second
+     * @param closest2 Set to the point on the second segment closest to the first
+     */
+    void getClosestOfSegments(glm::vec3 start1, glm::vec3 end1, glm::vec3 start2, glm::vec3 end2, glm::vec3& closest1, glm::vec3& closest2) {
+        glm::vec3 direction1 = end1 - start1;
+        glm::vec3 direction2 = end2 - start2;
+        glm::vec3 offset = start1 - start2;
+        float length1 = glm::dot(direction1, direction1);
+        float length2 = glm::dot(direction2, direction2);
+        float along2 = glm::dot(direction2, offset);
+
+        float t1, t2;
+        if (length1 <= 0.f && length2 <= 0.f) {
+            t1 = t2 = 0.f;
+        } else if (length1 <= 0.f) {
+            t1 = 0.f;
+            t2 = glm::clamp(along2 / length2, 0.f, 1.f);
+        } else {
+            float along1 = glm::dot(direction1, offset);
+            if (length2 <= 0.f) {
+                t2 = 0.f;
+                t1 = glm::clamp(-along1 / length1, 0.f, 1.f);
+            } else {
+                // Find the closest points of the infinite lines, then clamp each to its segment in turn
+                float between = glm::dot(direction1, direction2);
+                float denominator = length1 * length2 - between * between;
+                t1 = denominator > 0.f ? glm::clamp((between * along2 - along1 * length2) / denominator, 0.f, 1.f) : 0.f;
+                t2 = (between * t1 + along2) / length2;
+                if (t2 < 0.f) {
+                    t2 = 0.f;
+                    t1 = glm::clamp(-along1 / length1, 0.f, 1.f);
+                } else if (t2 > 1.f) {
+                    t2 = 1.f;
+                    t1 = glm::clamp((between - along1) / length1, 0.f, 1.f);
+                }
+            }
+        }
+
+        closest1 = start1 + direction1 * t1;
+        closest2 = start2 + direction2 * t2;
+    }
+
+    /**
+     * Test two spheres for collision, the capsule tests come down to this once the closest points of the segments
+     * are known
+     * @param fallbackNormal The direction to push the spheres apart in if their centres are in the same place
+     * @return The collision, with the normal pointing from the first sphere towards the second
+     */
+    CollisionResult roundRound(glm::vec3 centre1, glm::vec3 centre2, float radius, glm::vec3 fallbackNormal) {
+        glm::vec3 offset = centre2 - centre1;
+        float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared >= radius * radius) return {false};
+
+        float distance = std::sqrt(distanceSquared);
+        return {
+            true,
+            radius - distance + PrimitiveCollisions::COLLISION_MARGIN,
+            distance > 0.0001f ? offset / distance : fallbackNormal
+        };
+    }
+
+    /**
+     * Test a capsule against an oriented box, in the box's space
+     * @return The collision, with the normal pointing from the capsule towards the box
+     */
+    CollisionResult capsuleBox(const Capsule& capsule, const OrientedBox& box) {
+        auto toLocal = [&](glm::vec3 point) {
+            glm::vec3 offset = point - box.centre;
+            return glm::vec3(glm::dot(offset, box.axes[0]), glm::dot(offset, box.axes[1]), glm::dot(offset, box.axes[2]));
+        };
+        auto toWorld = [&](glm::vec3 direction) {
+            return box.axes[0] * direction.x + box.axes[1] * direction.y + box.axes[2] * direction.z;
+        };
+        glm::vec3 start = toLocal(capsule.start);
+        glm::vec3 direction = toLocal(capsule.end) - start;
+        glm::vec3 halfExtents = box.halfExtents;
+
+        // The squared distance from the segment to the box is a quadratic between the points where the segment
+        // crosses the planes of the box's faces, so find those points and the closest point between each pair of them
+        float breaks[8] = {0.f, 1.f};
+        size_t breakCount = 2;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (direction[axis] == 0.f) continue;
+            for (float side: {-halfExtents[axis], halfExtents[axis]}) {
+                float t = (side - start[axis]) / direction[axis];
+                if (t > 0.f && t < 1.f) breaks[breakCount++] = t;
+            }
+        }
+        std::sort(breaks, breaks + breakCount);
+
+        float minDistanceSquared = std::numeric_limits<float>::max();
+        glm::vec3 segmentPoint(0), boxPoint(0);
+        for (size_t i = 0; i + 1 < breakCount; ++i) {
+            // Between the breaks, the segment is either past or within each pair of faces the whole way
+            float middleT = (breaks[i] + breaks[i + 1]) * .5f;
+            glm::vec3 middle = start + direction * middleT;
+            float slope = 0.f, offset = 0.f;
+            for (int axis = 0; axis < 3; ++axis) {
+                // Axes the segment is within the faces on don't add to the distance
+                if (std::abs(middle[axis]) <= halfExtents[axis]) continue;
+                float side = middle[axis] < 0.f ? -halfExtents[axis] : halfExtents[axis];
+                slope += direction[axis] * direction[axis];
+                offset += direction[axis] * (start[axis] - side);
+            }
+            // With no faces in the way the segment is inside the box, the middle is used as the ends of the range can
+            // round to just outside it
+            float t = slope > 0.f ? glm::clamp(-offset / slope, breaks[i], breaks[i + 1]) : middleT;
+
+            glm::vec3 point = start + direction * t;
+            glm::vec3 closest = glm::clamp(point, -halfExtents, halfExtents);
+            glm::vec3 toClosest = closest - point;
+            float distanceSquared = glm::dot(toClosest, toClosest);
+            if (distanceSquared < minDistanceSquared) {
+                minDistanceSquared = distanceSquared;
+                segmentPoint = point;
+                boxPoint = closest;
+            }
+        }
+
+        if (minDistanceSquared > 0.f) {
+            // The segment is outside the box, so only the rounded part of the capsule can reach it
+            if (minDistanceSquared >= capsule.radius * capsule.radius) return {false};
+
+            float distance = std::sqrt(minDistanceSquared);
+            return {
+                true,
+                capsule.radius - distance + PrimitiveCollisions::COLLISION_MARGIN,
+                toWorld((boxPoint - segmentPoint) / distance)
+            };
+        }
+
+        // The segment is inside the box, push the capsule out along whichever of the box's axes, or the axes across
+        // the segment and the box's axes, they overlap least on
+        glm::vec3 centre = start + direction * .5f;
+        float minDistance = std::numeric_limits<float>::max();
+        glm::vec3 normal(1, 0, 0);
+        auto testAxis = [&](glm::vec3 axis) {
+            float boxRadius = glm::dot(halfExtents, glm::abs(axis));
+            float capsuleRadius = std::abs(glm::dot(direction, axis)) * .5f + capsule.radius;
+            float distance = -glm::dot(centre, axis);
+            float overlap = boxRadius + capsuleRadius - std::abs(distance);
+            if (overlap < minDistance) {
+                minDistance = overlap;
+                normal = distance >= 0.f ? axis : -axis;
+            }
+        };
+        for (int i = 0; i < 3; ++i) {
+            glm::vec3 axis(0);
+            axis[i] = 1;
+            testAxis(axis);
+        }
+        for (int i = 0; i < 3; ++i) {
+            glm::vec3 axis(0);
+            axis[i] = 1;
+            axis = glm::cross(direction, axis);
+            float lengthSquared = glm::dot(axis, axis);
+            if (lengthSquared < 1e-6f) continue;
+            testAxis(axis / std::sqrt(lengthSquared));
+        }
+
+        return {
+            true,
+            minDistance + PrimitiveCollisions::COLLISION_MARGIN,
+            toWorld(normal)
+        };
+    }
+
+    /**
+     * Find the point on a triangle closest to a point
+     * Follows the Voronoi regions of the triangle, from Real-Time Collision Detection by Christer Ericson
+     */
+    glm::vec3 getClosestOnTriangle(const Triangle& triangle, glm::vec3 point) {
+        glm::vec3 ab = triangle.b - triangle.a;
+        glm::vec3 ac = triangle.c - triangle.a;
+        glm::vec3 ap = point - triangle.a;
+        float d1 = glm::dot(ab, ap);
+        float d2 = glm::dot(ac, ap);
+        if (d1 <= 0.f && d2 <= 0.f) return triangle.a;
+
+        glm::vec3 bp = point - triangle.b;
+        float d3 = glm::dot(ab, bp);
+        float d4 = glm::dot(ac, bp);
+        if (d3 >= 0.f && d4 <= d3) return triangle.b;
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return triangle.a + ab * (d1 / (d1 - d3));
+
+        glm::vec3 cp = point - triangle.c;
+        float d5 = glm::dot(ab, cp);
+        float d6 = glm::dot(ac, cp);
+        if (d6 >= 0.f && d5 <= d6) return triangle.c;
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return triangle.a + ac * (d2 / (d2 - d6));
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+            return triangle.b + (triangle.c - triangle.b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        float total = va + vb + vc;
+        return triangle.a + ab * (vb / total) + ac * (vc / total);
+    }
+
+    /**
+     * Get the normal of a triangle facing the side a point is on, used to push shapes out of triangles they touch
+     */
+    glm::vec3 getNormalTowards(const Triangle& triangle, glm::vec3 point) {
+        glm::vec3 normal = triangle.getNormal();
+        return glm::dot(point - triangle.a, normal) >= 0.f ? normal : -normal;
+    }
+
+    /**
+     * Test a triangle against an oriented box with the separating axis test, in the box's space
+     * @return The collision, with the normal pointing from the triangle towards the box
+     */
+    CollisionResult triangleBox(const Triangle& triangle, const OrientedBox& box) {
+        auto toLocal = [&](glm::vec3 point) {
+            glm::vec3 offset = point - box.centre;
+            return glm::vec3(glm::dot(offset, box.axes[0]), glm::dot(offset, box.axes[1]), glm::dot(offset, box.axes[2]));
+        };
+        auto toWorld = [&](glm::vec3 direction) {
+            return box.axes[0] * direction.x + box.axes[1] * direction.y + box.axes[2] * direction.z;
+        };
+        const glm::vec3 corners[3] = {toLocal(triangle.a), toLocal(triangle.b), toLocal(triangle.c)};
+        const glm::vec3 edges[3] = {corners[1] - corners[0], corners[2] - corners[1], corners[0] - corners[2]};
+
+        float minDistance = std::numeric_limits<float>::max();
+        glm::vec3 normal(0);
+
+        // Returns false if the triangle and box are apart along the axis, otherwise keeps the axis if the box has to
+        // move least along it to get out
+        auto testAxis = [&](glm::vec3 axis) {
+            float boxRadius = glm::dot(box.halfExtents, glm::abs(axis));
+            float first = glm::dot(corners[0], axis);
+            float second = glm::dot(corners[1], axis);
+            float third = glm::dot(corners[2], axis);
+            float triangleMin = std::min(first, std::min(second, third));
+            float triangleMax = std::max(first, std::max(second, third));
+
+            float up = triangleMax + boxRadius;
+            float down = boxRadius - triangleMin;
+            if (up <= 0.f || down <= 0.f) return false;
+
+            if (up < minDistance) {
+                minDistance = up;
+                normal = axis;
+            }
+            if (down < minDistance) {
+                minDistance = down;
+                normal = -axis;
+            }
+            return true;
+        };
+
+        // The faces are tested first, so they win ties with the edges
+        glm::vec3 faceNormal = glm::cross(edges[0], edges[1]);
+        float faceLengthSquared = glm::dot(faceNormal, faceNormal);
+        if (faceLengthSquared > 0.f && !testAxis(faceNormal / std::sqrt(faceLengthSquared))) return {false};
+        for (int i = 0; i < 3; ++i) {
+            glm::vec3 axis(0);
+            axis[i] = 1;
+            if (!testAxis(axis)) return {false};
+        }
+
+        // Edges that are nearly parallel to an axis of the box don't give an axis, and are covered by the box's faces
+        for (const glm::vec3& edge: edges) {
+            for (int i = 0; i < 3; ++i) {
+                glm::vec3 axis(0);
+                axis[i] = 1;
+                axis = glm::cross(edge, axis);
+                float lengthSquared = glm::dot(axis, axis);
+                if (lengthSquared < 1e-6f * glm::dot(edge, edge)) continue;
+                if (!testAxis(axis / std::sqrt(lengthSquared))) return {false};
+            }
+        }
+
+        return {
+            true,
+            minDistance + PrimitiveCollisions::COLLISION_MARGIN,
+            toWorld(normal)
+        };
+    }
+
+    /**
+     * Test a triangle against a capsule, from the closest points of the triangle and the capsule's segment
+     * @return The collision, with the normal pointing from the triangle towards the capsule
+     */
+    CollisionResult triangleCapsuleShape(const Triangle& triangle, const Capsule& capsule) {
+        glm::vec3 normal = triangle.getNormal();
+        glm::vec3 direction = capsule.end - capsule.start;
+
+        // Check if the segment goes through the triangle, as then the closest points below won't find it
+        bool crosses = false;
+        float startSide = glm::dot(capsule.start - triangle.a, normal);
+        float endSide = glm::dot(capsule.end - triangle.a, normal);
+        if ((startSide <= 0.f) != (endSide <= 0.f)) {
+            glm::vec3 crossing = capsule.start + direction * (startSide / (startSide - endSide));
+            crosses = glm::dot(glm::cross(triangle.b - triangle.a, crossing - triangle.a), normal) >= 0.f
+                   && glm::dot(glm::cross(triangle.c - triangle.b, crossing - triangle.b), normal) >= 0.f
+                   && glm::dot(glm::cross(triangle.a - triangle.c, crossing - triangle.c), normal) >= 0.f;
+        }
+
+        if (!crosses) {
+            // The closest points are either an end of the segment and the face, or the segment and an edge
+            glm::vec3 segmentPoint = capsule.start;
+            glm::vec3 trianglePoint = getClosestOnTriangle(triangle, capsule.start);
+            float minDistanceSquared = glm::dot(trianglePoint - segmentPoint, trianglePoint - segmentPoint);
+            auto keepCloser = [&](glm::vec3 point1, glm::vec3 point2) {
+                float distanceSquared = glm::dot(point2 - point1, point2 - point1);
+                if (distanceSquared < minDistanceSquared) {
+                    minDistanceSquared = distanceSquared;
+                    segmentPoint = point1;
+                    trianglePoint = point2;
+                }
+            };
+            keepCloser(capsule.end, getClosestOnTriangle(triangle, capsule.end));
+            const glm::vec3 corners[4] = {triangle.a, triangle.b, triangle.c, triangle.a};
+            for (int i = 0; i < 3; ++i) {
+                glm::vec3 closest1, closest2;
+                getClosestOfSegments(capsule.start, capsule.end, corners[i], corners[i + 1], closest1, closest2);
+                keepCloser(closest1, closest2);
+            }
+
+            // A segment that only just misses crossing the triangle, such as through an edge, has no clear direction
+            // to push in, so is pushed out the same way as one that crosses it
+            if (minDistanceSquared >= capsule.radius * capsule.radius) return {false};
+            if (minDistanceSquared > 1e-8f) {
+                glm::vec3 centre = capsule.start + direction * .5f;
+                return roundRound(trianglePoint, segmentPoint, capsule.radius, getNormalTowards(triangle, centre));
+            }
+        }
+
+        // Push the capsule out along whichever of the triangle's normal, or the axes across the segment and the
+        // triangle's edges, they overlap least on
+        float minDistance = std::numeric_limits<float>::max();
+        glm::vec3 pushNormal = normal;
+        auto testAxis = [&](glm::vec3 axis) {
+            float first = glm::dot(triangle.a, axis);
+            float second = glm::dot(triangle.b, axis);
+            float third = glm::dot(triangle.c, axis);
+            float start = glm::dot(capsule.start, axis);
+            float end = glm::dot(capsule.end, axis);
+
+            float up = std::max(first, std::max(second, third)) - std::min(start, end) + capsule.radius;
+            float down = std::max(start, end) - std::min(first, std::min(second, third)) + capsule.radius;
+            if (up < minDistance) {
+                minDistance = up;
+                pushNormal = axis;
+            }
+            if (down < minDistance) {
+                minDistance = down;
+                pushNormal = -axis;
+            }
+        };
+        testAxis(normal);
+        const glm::vec3 edges[3] = {triangle.b - triangle.a, triangle.c - triangle.b, triangle.a - triangle.c};
+        for (const glm::vec3& edge: edges) {
+            glm::vec3 axis = glm::cross(direction, edge);
+            float lengthSquared = glm::dot(axis, axis);
+            if (lengthSquared < 1e-6f * glm::dot(edge, edge)) continue;
+            testAxis(axis / std::sqrt(lengthSquared));
+        }
+
+        return {
+            true,
+            minDistance + PrimitiveCollisions::COLLISION_MARGIN,
+            pushNormal
+        };
+    }
+
+    /**
+     * Run a test on each triangle and keep the deepest collision, the same way the collision engine picks between the
+     * children of a compound
+     */
+    template<typename Test>
+    CollisionResult getDeepest(const Triangle* triangles, size_t triangleCount, Test&& test) {
+        CollisionResult deepest = {false, 0, glm::vec3(0)};
+        for (size_t i = 0; i < triangleCount; ++i) {
+            CollisionResult result = test(triangles[i]);
+            if (result.collided && (!deepest.collided || result.depth > deepest.depth)) deepest = result;
+        }
+        return deepest;
+    }
+}
+
+CollisionResult PrimitiveCollisions::sphereSphere(const Collider* sphere1, const Collider* sphere2) {
+    float radius = static_cast<const SphereCollider*>(sphere1)->getRadius() + static_cast<const SphereCollider*>(sphere2)->getRadius();
+    glm::vec3 offset = sphere2->getPosition() - sphere1->getPosition();
+
+    float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared >= radius * radius) return {false};
+
+    // Concentric spheres can be pushed apart in any direction, use the same one GJK starts with
+    float distance = std::sqrt(distanceSquared);
+    glm::vec3 normal = distance > 0.0001f ? offset / distance : glm::vec3(1, 0, 0);
+
+    return {
+        true,
+        radius - distance + COLLISION_MARGIN,
+        normal
+    };
+}
+
+CollisionResult PrimitiveCollisions::sphereAABB(const Collider* sphere, const Collider* box) {
+    float radius = static_cast<const SphereCollider*>(sphere)->getRadius();
+    glm::vec3 centre = sphere->getPosition();
+
+    const BoundingBox& localBox = static_cast<const AABBCollider*>(box)->getBox();
+    glm::vec3 boxMin = localBox.min + box->getPosition();
+    glm::vec3 boxMax = localBox.max + box->getPosition();
+
+    glm::vec3 closest = glm::clamp(centre, boxMin, boxMax);
+    glm::vec3 offset = closest - centre;
+    float distanceSquared = glm::dot(offset, offset);
+
+    if (distanceSquared > 0.f) {
+        // The centre is outside the box, so the closest point on the box is the deepest point in the sphere
+        if (distanceSquared >= radius * radius) return {false};
+
+        float distance = std::sqrt(distanceSquared);
+        return {
+            true,
+            radius - distance + COLLISION_MARGIN,
+            offset / distance
+        };
+    }
+
+    // The centre is inside the box, push the sphere out through the nearest face
+    glm::vec3 toMin = centre - boxMin;
+    glm::vec3 toMax = boxMax - centre;
+
+    glm::vec3 normal(1, 0, 0);
+    float minDistance = toMin.x;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (toMin[axis] < minDistance) {
+            minDistance = toMin[axis];
+            normal = glm::vec3(0);
+            normal[axis] = 1;
+        }
+        if (toMax[axis] < minDistance) {
+            minDistance = toMax[axis];
+            normal = glm::vec3(0);
+            normal[axis] = -1;
+        }
+    }
+
+    return {
+        true,
+        minDistance + radius + COLLISION_MARGIN,
+        normal
+    };
+}
+
+CollisionResult PrimitiveCollisions::aabbAABB(const Collider* box1, const Collider* box2) {
+    const BoundingBox& localBox1 = static_cast<const AABBCollider*>(box1)->getBox();
+    const BoundingBox& localBox2 = static_cast<const AABBCollider*>(box2)->getBox();
+
+    glm::vec3 min1 = localBox1.min + box1->getPosition();
+    glm::vec3 max1 = localBox1.max + box1->getPosition();
+    glm::vec3 min2 = localBox2.min + box2->getPosition();
+    glm::vec3 max2 = localBox2.max + box2->getPosition();
+
+    // How far the first box has to move down and up each axis to separate
+    glm::vec3 down = max1 - min2;
+    glm::vec3 up = max2 - min1;
+
+    glm::vec3 normal(0);
+    float minDistance = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        if (down[axis] <= 0.f || up[axis] <= 0.f) return {false};
+
+        if (down[axis] < minDistance) {
+            minDistance = down[axis];
+            normal = glm::vec3(0);
+            normal[axis] = 1;
+        }
+        if (up[axis] < minDistance) {
+            minDistance = up[axis];
+            normal = glm::vec3(0);
+            normal[axis] = -1;
+        }
+    }
+
+    return {
+        true,
+        minDistance + COLLISION_MARGIN,
+        normal
+    };
+}
+
+CollisionResult PrimitiveCollisions::obbOBB(const Collider* box1, const Collider* box2) {
+    return boxBox(static_cast<const OBBCollider*>(box1)->getWorldBox(), static_cast<const OBBCollider*>(box2)->getWorldBox());
+}
+
+CollisionResult PrimitiveCollisions::aabbOBB(const Collider* box1, const Collider* box2) {
+    return boxBox(getAxisAlignedBox(box1), static_cast<const OBBCollider*>(box2)->getWorldBox());
+}
+
+CollisionResult PrimitiveCollisions::sphereOBB(const Collider* sphere, const Collider* box) {
+    float radius = static_cast<const SphereCollider*>(sphere)->getRadius();
+    OrientedBox orientedBox = static_cast<const OBBCollider*>(box)->getWorldBox();
+
+    // Work in the box's space, where it is an axis aligned box around the origin
+    glm::vec3 offset = sphere->getPosition() - orientedBox.centre;
+    glm::vec3 centre(glm::dot(offset, orientedBox.axes[0]), glm::dot(offset, orientedBox.axes[1]), glm::dot(offset, orientedBox.axes[2]));
+    auto toWorld = [&](glm::vec3 direction) {
+        return orientedBox.axes[0] * direction.x + orientedBox.axes[1] * direction.y + orientedBox.axes[2] * direction.z;
+    };
+
+    glm::vec3 closest = glm::clamp(centre, -orientedBox.halfExtents, orientedBox.halfExtents);
+    glm::vec3 toClosest = closest - centre;
+    float distanceSquared = glm::dot(toClosest, toClosest);
+
+    if (distanceSquared > 0.f) {
+        // The centre is outside the box, so the closest point on the box is the deepest point in the sphere
+        if (distanceSquared >= radius * radius) return {false};
+
+        float distance = std::sqrt(distanceSquared);
+        return {
+            true,
+            radius - distance + COLLISION_MARGIN,
+            toWorld(toClosest / distance)
+        };
+    }
+
+    // The centre is inside the box, push the sphere out through the nearest face
+    glm::vec3 toMin = centre + orientedBox.halfExtents;
+    glm::vec3 toMax = orientedBox.halfExtents - centre;
+
+    glm::vec3 normal(1, 0, 0);
+    float minDistance = toMin.x;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (toMin[axis] < minDistance) {
+            minDistance = toMin[axis];
+            normal = glm::vec3(0);
+            normal[axis] = 1;
+        }
+        if (toMax[axis] < minDistance) {
+            minDistance = toMax[axis];
+            normal = glm::vec3(0);
+            normal[axis] = -1;
+        }
+    }
+
+    return {
+        true,
+        minDistance + radius + COLLISION_MARGIN,
+        toWorld(normal)
+    };
+}
+
+CollisionResult PrimitiveCollisions::capsuleCapsule(const Collider* capsule1, const Collider* capsule2) {
+    Capsule worldCapsule1 = static_cast<const CapsuleCollider*>(capsule1)->getWorldCapsule();
+    Capsule worldCapsule2 = static_cast<const CapsuleCollider*>(capsule2)->getWorldCapsule();
+
+    glm::vec3 closest1, closest2;
+    getClosestOfSegments(worldCapsule1.start, worldCapsule1.end, worldCapsule2.start, worldCapsule2.end, closest1, closest2);
+
+    // If the segments cross, push the capsules apart across both of them, towards the second capsule
+    glm::vec3 axis1 = worldCapsule1.end - worldCapsule1.start;
+    glm::vec3 axis2 = worldCapsule2.end - worldCapsule2.start;
+    glm::vec3 across = glm::cross(axis1, axis2);
+    glm::vec3 fallbackNormal = glm::dot(across, across) > 1e-8f ? glm::normalize(across) : getPerpendicular(axis1);
+    glm::vec3 centreOffset = (worldCapsule2.start + worldCapsule2.end - worldCapsule1.start - worldCapsule1.end) * .5f;
+    if (glm::dot(fallbackNormal, centreOffset) < 0.f) fallbackNormal = -fallbackNormal;
+
+    return roundRound(closest1, closest2, worldCapsule1.radius + worldCapsule2.radius, fallbackNormal);
+}
+
+CollisionResult PrimitiveCollisions::capsuleSphere(const Collider* capsule, const Collider* sphere) {
+    Capsule worldCapsule = static_cast<const CapsuleCollider*>(capsule)->getWorldCapsule();
+    glm::vec3 centre = sphere->getPosition();
+
+    float t = getClosestOnSegment(worldCapsule.start, worldCapsule.end, centre);
+    glm::vec3 closest = worldCapsule.start + (worldCapsule.end - worldCapsule.start) * t;
+    float radius = worldCapsule.radius + static_cast<const SphereCollider*>(sphere)->getRadius();
+
+    return roundRound(closest, centre, radius, getPerpendicular(worldCapsule.end - worldCapsule.start));
+}
+
+CollisionResult PrimitiveCollisions::capsuleAABB(const Collider* capsule, const Collider* box) {
+    return capsuleBox(static_cast<const CapsuleCollider*>(capsule)->getWorldCapsule(), getAxisAlignedBox(box));
+}
+
+CollisionResult PrimitiveCollisions::capsuleOBB(const Collider* capsule, const Collider* box) {
+    return capsuleBox(static_cast<const CapsuleCollider*>(capsule)->getWorldCapsule(), static_cast<const OBBCollider*>(box)->getWorldBox());
+}
+
+CollisionResult PrimitiveCollisions::triangleSphere(const Triangle* triangles, size_t triangleCount, const Collider* sphere) {
+    glm::vec3 centre = sphere->getPosition();
+    float radius = static_cast<const SphereCollider*>(sphere)->getRadius();
+
+    return getDeepest(triangles, triangleCount, [&](const Triangle& triangle) {
+        glm::vec3 closest = getClosestOnTriangle(triangle, centre);
+        return roundRound(closest, centre, radius, getNormalTowards(triangle, centre));
+    });
+}
+
+CollisionResult PrimitiveCollisions::triangleCapsule(const Triangle* triangles, size_t triangleCount, const Collider* capsule) {
+    Capsule worldCapsule = static_cast<const CapsuleCollider*>(capsule)->getWorldCapsule();
+    return getDeepest(triangles, triangleCount, [&](const Triangle& triangle) {
+        return triangleCapsuleShape(triangle, worldCapsule);
+    });
+}
+
+CollisionResult PrimitiveCollisions::triangleAABB(const Triangle* triangles, size_t triangleCount, const Collider* box) {
+    OrientedBox orientedBox = getAxisAlignedBox(box);
+    return getDeepest(triangles, triangleCount, [&](const Triangle& triangle) {
+        return triangleBox(triangle, orientedBox);
+    });
+}
+
+CollisionResult PrimitiveCollisions::triangleOBB(const Triangle* triangles, size_t triangleCount, const Collider* box) {
+    OrientedBox orientedBox = static_cast<const OBBCollider*>(box)->getWorldBox();
+    return getDeepest(triangles, triangleCount, [&](const Triangle& triangle) {
+        return triangleBox(triangle, orientedBox);
+    });
+}
@@ -7,20 +7,30 @@
 #include <glm/ext/matrix_transform.hpp>
 
 static Mesh* sphereMesh = Mesh::createNewMeshFromFile(FileUtils::getAssetsPath() + "/Shapes/Sphere.lmesh");
+// The sphere mesh isn't a unit sphere, so the radius given to the collider is a scale on the mesh's radius
+static float sphereMeshRadius = sphereMesh != nullptr ? sphereMesh->boundingBox.max.x : 0.f;
 
-SphereCollider::SphereCollider(CollisionMode collisionMode, float radius) : MeshCollider(collisionMode, sphereMesh), radius(radius) {}
+SphereCollider::SphereCollider(CollisionMode collisionMode, float radius) : MeshCollider(collisionMode, sphereMesh, ColliderType::SPHERE), radius(radius) {}
 
-BoundingBox SphereCollider::getBoundingBox() {
+BoundingBox SphereCollider::getBoundingBox() const {
     return {
         glm::vec3(-radius),
         glm::vec3(radius)
     };
 }
 
+float SphereCollider::getRadius() const {
+    return radius * sphereMeshRadius;
+}
+
 glm::vec3 SphereCollider::findFurthestPointInDirection(glm::vec3 direction) const {
     return MeshCollider::findFurthestPointInDirection(direction) * radius;
 }
 
+glm::vec3 SphereCollider::findFurthestPointInDirection(glm::vec3 direction, uint32_t& hint) const {
+    return MeshCollider::findFurthestPointInDirection(direction, hint) * radius;
+}
+
 glm::mat4 SphereCollider::getRenderMeshTransform() {
     return glm::scale(this->getTransform(), glm::vec3(radius));
 }
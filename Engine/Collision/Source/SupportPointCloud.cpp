@@ -0,0 +1,161 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/SupportPointCloud.h"
+
+#include <cstring>
+#include <unordered_set>
+
+// Runtime dispatch uses the GCC/Clang target attribute, other compilers get the scalar search
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SUPPORT_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace {
+    using FurthestPointKernel = size_t (*)(const float* xs, const float* ys, const float* zs, size_t count, glm::vec3 direction);
+
+    /*=================================*/
+    /* Kernels                         */
+    /*=================================*/
+    // All kernels calculate the dot product in the same order as glm::dot, and keep the first of equally far points,
+    // so they all give the same result
+
+    size_t furthestPointScalar(const float* xs, const float* ys, const float* zs, size_t count, glm::vec3 direction) {
+        size_t maxPoint = 0;
+        float maxDistance = direction.x * xs[0] + direction.y * ys[0] + direction.z * zs[0];
+        for (size_t i = 1; i < count; ++i) {
+            float distance = direction.x * xs[i] + direction.y * ys[i] + direction.z * zs[i];
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                maxPoint = i;
+            }
+        }
+        return maxPoint;
+    }
+
+    /**
+     * Pick the furthest point out of the furthest point found by each lane
+     */
+    size_t reduceLanes(const float* distances, const int32_t* indices, size_t lanes) {
+        size_t best = 0;
+        for (size_t lane = 1; lane < lanes; ++lane) {
+            if (distances[lane] > distances[best] || (distances[lane] == distances[best] && indices[lane] < indices[best])) {
+                best = lane;
+            }
+        }
+        return indices[best];
+    }
+
+#ifdef SUPPORT_X86_DISPATCH
+    __attribute__((target("sse4.1")))
+    size_t furthestPointSSE(const float* xs, const float* ys, const float* zs, size_t count, glm::vec3 direction) {
+        const __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+        const __m128i step = _mm_set1_epi32(4);
+
+        __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+        __m128 maxDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_load_ps(xs)), _mm_mul_ps(dy, _mm_load_ps(ys))), _mm_mul_ps(dz, _mm_load_ps(zs)));
+        __m128i maxIndex = index;
+
+        for (size_t i = 4; i < count; i += 4) {
+            index = _mm_add_epi32(index, step);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_load_ps(xs + i)), _mm_mul_ps(dy, _mm_load_ps(ys + i))), _mm_mul_ps(dz, _mm_load_ps(zs + i)));
+            __m128 further = _mm_cmpgt_ps(distance, maxDistance);
+            maxDistance = _mm_blendv_ps(maxDistance, distance, further);
+            maxIndex = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(maxIndex), _mm_castsi128_ps(index), further));
+        }
+
+        alignas(16) float distances[4];
+        alignas(16) int32_t indices[4];
+        _mm_store_ps(distances, maxDistance);
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), maxIndex);
+        return reduceLanes(distances, indices, 4);
+    }
+
+    __attribute__((target("avx2")))
+    size_t furthestPointAVX2(const float* xs, const float* ys, const float* zs, size_t count, glm::vec3 direction) {
+        const __m256 dx = _mm256_set1_ps(direction.x), dy = _mm256_set1_ps(direction.y), dz = _mm256_set1_ps(direction.z);
+        const __m256i step = _mm256_set1_epi32(8);
+
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256 maxDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_load_ps(xs)), _mm256_mul_ps(dy, _mm256_load_ps(ys))), _mm256_mul_ps(dz, _mm256_load_ps(zs)));
+        __m256i maxIndex = index;
+
+        for (size_t i = 8; i < count; i += 8) {
+            index = _mm256_add_epi32(index, step);
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, _mm256_load_ps(xs + i)), _mm256_mul_ps(dy, _mm256_load_ps(ys + i))), _mm256_mul_ps(dz, _mm256_load_ps(zs + i)));
+            __m256 further = _mm256_cmp_ps(distance, maxDistance, _CMP_GT_OQ);
+            maxDistance = _mm256_blendv_ps(maxDistance, distance, further);
+            maxIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(maxIndex), _mm256_castsi256_ps(index), further));
+        }
+
+        alignas(32) float distances[8];
+        alignas(32) int32_t indices[8];
+        _mm256_store_ps(distances, maxDistance);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(indices), maxIndex);
+        return reduceLanes(distances, indices, 8);
+    }
+#endif
+
+    FurthestPointKernel selectKernel() {
+#ifdef SUPPORT_X86_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return furthestPointAVX2;
+        if (__builtin_cpu_supports("sse4.1")) return furthestPointSSE;
+#endif
+        return furthestPointScalar;
+    }
+
+    /**
+     * Hash a position by its bits, so only exactly equal positions are merged
+     */
+    struct PositionHash {
+        size_t operator()(const glm::vec3& position) const {
+            uint32_t bits[3];
+            std::memcpy(bits, &position, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct PositionEqual {
+        bool operator()(const glm::vec3& a, const glm::vec3& b) const {
+            return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+        }
+    };
+}
+
+SupportPointCloud::SupportPointCloud(const std::vector<glm::vec3>& points) {
+    // Meshes repeat positions for every normal and uv, which never change the support point
+    std::unordered_set<glm::vec3, PositionHash, PositionEqual> seen;
+    for (const glm::vec3& point: points) {
+        if (!seen.insert(point).second) continue;
+        xs.push_back(point.x);
+        ys.push_back(point.y);
+        zs.push_back(point.z);
+    }
+    count = xs.size();
+
+    // Pad with the first point, which can never be further than itself so doesn't change the result
+    if (count == 0) return;
+    while (xs.size() % 8 != 0) {
+        xs.push_back(xs[0]);
+        ys.push_back(ys[0]);
+        zs.push_back(zs[0]);
+    }
+}
+
+size_t SupportPointCloud::size() const {
+    return count;
+}
+
+glm::vec3 SupportPointCloud::getPoint(size_t index) const {
+    return {xs[index], ys[index], zs[index]};
+}
+
+size_t SupportPointCloud::findFurthestPointIndex(glm::vec3 direction) const {
+    static const FurthestPointKernel kernel = selectKernel();
+
+    if (count == 0) return 0;
+    return kernel(xs.data(), ys.data(), zs.data(), xs.size(), direction);
+}
@@ -0,0 +1,164 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Collision/TriangleMeshCollider.h"
+
+#include <Utils/Logger.h>
+
+#include <glm/glm.hpp>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#define TRIANGLEMESHVERSION 1
+
+TriangleMeshCollider::TriangleMeshCollider(CollisionMode collisionMode, Mesh* mesh) : Collider(collisionMode, ColliderType::TRIANGLE_MESH), mesh(mesh) {
+    if (mesh == nullptr) return;
+
+    positions.reserve(mesh->vertices.size());
+    for (const Vertex& vertex: mesh->vertices) {
+        positions.push_back(vertex.position);
+    }
+
+    std::vector<uint32_t> meshIndices;
+    meshIndices.reserve(mesh->indices.size());
+    for (size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+        const uint32_t* corners = &mesh->indices[i];
+        if (corners[0] >= positions.size() || corners[1] >= positions.size() || corners[2] >= positions.size()) continue;
+
+        glm::vec3 area = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+        if (glm::dot(area, area) <= 0.f) continue;
+        meshIndices.insert(meshIndices.end(), corners, corners + 3);
+    }
+    indices = std::move(meshIndices);
+    auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0) return;
+
+    std::vector<BoundingBox> bounds;
+    bounds.reserve(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+        bounds.push_back(getTriangleBounds(i));
+    }
+
+    std::vector<uint32_t> order;
+    hierarchy.build(bounds, order);
+
+    std::vector<uint32_t> sortedIndices;
+    sortedIndices.reserve(indices.size());
+    for (uint32_t triangle: order) {
+        sortedIndices.insert(sortedIndices.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+    }
+    indices = std::move(sortedIndices);
+}
+
+BoundingBox TriangleMeshCollider::getTriangleBounds(uint32_t triangle) const {
+    const uint32_t* corners = &indices[triangle * 3];
+    glm::vec3 a = positions[corners[0]];
+    glm::vec3 b = positions[corners[1]];
+    glm::vec3 c = positions[corners[2]];
+    return {glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c))};
+}
+
+bool TriangleMeshCollider::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        Logger::warn("Failed to save triangle mesh collider at " + filePath);
+        return false;
+    }
+
+    uint8_t version = TRIANGLEMESHVERSION;
+    auto positionCount = static_cast<uint32_t>(positions.size());
+    auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    uint32_t nodeCount = hierarchy.getNodeCount();
+    file.write(reinterpret_cast<const char*>(&version), 1);
+    file.write(reinterpret_cast<const char*>(&positionCount), 4);
+    file.write(reinterpret_cast<const char*>(&triangleCount), 4);
+    file.write(reinterpret_cast<const char*>(&nodeCount), 4);
+    file.write(reinterpret_cast<const char*>(positions.data()), positionCount * sizeof(glm::vec3));
+    file.write(reinterpret_cast<const char*>(indices.data()), triangleCount * 3 * sizeof(uint32_t));
+    hierarchy.write(file);
+
+    file.close();
+    return true;
+}
+
+bool TriangleMeshCollider::loadFromFile(const std::string& filePath) {
+    if (!std::filesystem::exists(filePath)) {
+        Logger::warn("Failed to load triangle mesh collider at " + filePath);
+        return false;
+    }
+    std::ifstream file(filePath, std::ios::binary);
+    uint8_t version;
+    uint32_t positionCount, triangleCount, nodeCount;
+    file.read(reinterpret_cast<char*>(&version), 1);
+    if (version != TRIANGLEMESHVERSION) {
+        Logger::warn("Incorrect version of triangle mesh collider standard, this file cannot be read");
+        file.close();
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&positionCount), 4);
+    file.read(reinterpret_cast<char*>(&triangleCount), 4);
+    file.read(reinterpret_cast<char*>(&nodeCount), 4);
+    if (!file || std::filesystem::file_size(filePath) < 13 + positionCount * sizeof(glm::vec3) + static_cast<uintmax_t>(triangleCount) * 3 * sizeof(uint32_t) + nodeCount * sizeof(FlatBVH::Node)) {
+        Logger::warn("Triangle mesh collider at " + filePath + " is corrupt");
+        file.close();
+        return false;
+    }
+
+    std::vector<glm::vec3> newPositions(positionCount);
+    std::vector<uint32_t> newIndices(static_cast<size_t>(triangleCount) * 3);
+    file.read(reinterpret_cast<char*>(newPositions.data()), positionCount * sizeof(glm::vec3));
+    file.read(reinterpret_cast<char*>(newIndices.data()), newIndices.size() * sizeof(uint32_t));
+    FlatBVH newHierarchy(MAX_LEAF_TRIANGLES);
+    bool valid = static_cast<bool>(file) && newHierarchy.read(file, nodeCount, triangleCount);
+    file.close();
+
+    // Queries follow the indices without checking them, so make sure they can't leave the positions
+    for (size_t i = 0; valid && i < newIndices.size(); ++i) {
+        valid = newIndices[i] < positionCount;
+    }
+    if (!valid) {
+        Logger::warn("Triangle mesh collider at " + filePath + " is corrupt");
+        return false;
+    }
+
+    positions = std::move(newPositions);
+    indices = std::move(newIndices);
+    hierarchy = std::move(newHierarchy);
+    return true;
+}
+
+size_t TriangleMeshCollider::getTriangleCount() const {
+    return indices.size() / 3;
+}
+
+BoundingBox TriangleMeshCollider::getBoundingBox() const {
+    if (hierarchy.empty()) return {glm::vec3(0), glm::vec3(0)};
+    return hierarchy.getBounds().transformed(glm::mat3(getTransform()));
+}
+
+glm::vec3 TriangleMeshCollider::findFurthestPointInDirection(glm::vec3 direction) const {
+    glm::mat4 transform = getTransform();
+    glm::vec3 position(transform[3]);
+
+    glm::vec3 furthest(0);
+    float maxDistance = -std::numeric_limits<float>::max();
+    for (const glm::vec3& corner: positions) {
+        glm::vec3 point = glm::vec3(transform * glm::vec4(corner, 1)) - position;
+        float distance = glm::dot(point, direction);
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            furthest = point;
+        }
+    }
+    return furthest;
+}
+
+Mesh* TriangleMeshCollider::getRenderMesh() {
+    return mesh;
+}
+
+glm::mat4 TriangleMeshCollider::getRenderMeshTransform() {
+    return getTransform();
+}
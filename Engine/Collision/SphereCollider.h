@@ -8,15 +8,24 @@
 #include <glm/fwd.hpp>
 #include "MeshCollider.h"
 
-class SphereCollider : public MeshCollider {
+class SphereCollider final : public MeshCollider {
 protected:
     float radius;
 public:
     SphereCollider(CollisionMode collisionMode, float radius);
 
-    BoundingBox getBoundingBox() override;
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Get the radius of the sphere the collider collides as, the radius of the sphere mesh scaled by the collider's radius
+     * @return The radius of the sphere
+     */
+    [[nodiscard]] float getRadius() const;
 
     glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
 
+    /** @copydoc MeshCollider::findFurthestPointInDirection(glm::vec3, uint32_t&) */
+    glm::vec3 findFurthestPointInDirection(glm::vec3 direction, uint32_t& hint) const;
+
     glm::mat4 getRenderMeshTransform() override;
 };
@@ -0,0 +1,144 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "Collider.h"
+#include "AABBCollider.h"
+#include "SphereCollider.h"
+#include "MeshCollider.h"
+#include "OBBCollider.h"
+#include "CapsuleCollider.h"
+#include "Triangle.h"
+
+/*
+ * Support functions for GJK and EPA, one for each built-in collider type
+ * Each one finds the furthest point of a collider in a direction in world space. The collider's world position is
+ * fetched once, into position, when the support is made, so GJK doesn't walk the collider's parents for every point.
+ * Each built-in support calls its collider's own implementation directly, so the call is resolved at compile time
+ * and can be inlined into the GJK kernel instantiated for it. This is why the built-in colliders are final, apart from
+ * MeshCollider, whose subclasses are given a ColliderSupport instead.
+ * The supports that hill climb a convex hull start from a hint owned by the caller, so a pair tested again next frame
+ * can start from the vertices it found last time.
+ */
+
+/**
+ * The support function of an AABBCollider
+ */
+struct AABBSupport {
+    glm::vec3 position;
+    glm::vec3 min, max;
+
+    explicit AABBSupport(const Collider* collider) : position(collider->getPosition()) {
+        const BoundingBox& box = static_cast<const AABBCollider*>(collider)->getBox();
+        min = box.min + position;
+        max = box.max + position;
+    }
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return {
+                (direction.x > 0 ? max.x : min.x),
+                (direction.y > 0 ? max.y : min.y),
+                (direction.z > 0 ? max.z : min.z)
+        };
+    }
+};
+
+/**
+ * The support function of a SphereCollider
+ */
+struct SphereSupport {
+    const SphereCollider* collider;
+    glm::vec3 position;
+    /** The hull vertex the last search found, where the next search starts, owned by the caller */
+    uint32_t& hint;
+
+    SphereSupport(const Collider* collider, uint32_t& hint)
+            : collider(static_cast<const SphereCollider*>(collider)), position(collider->getPosition()), hint(hint) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return collider->SphereCollider::findFurthestPointInDirection(direction, hint) + position;
+    }
+};
+
+/**
+ * The support function of a MeshCollider
+ */
+struct MeshSupport {
+    const MeshCollider* collider;
+    glm::vec3 position;
+    /** The hull vertex the last search found, where the next search starts, owned by the caller */
+    uint32_t& hint;
+
+    MeshSupport(const Collider* collider, uint32_t& hint)
+            : collider(static_cast<const MeshCollider*>(collider)), position(collider->getPosition()), hint(hint) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return collider->MeshCollider::findFurthestPointInDirection(direction, hint) + position;
+    }
+};
+
+/**
+ * The support function of an OBBCollider
+ * The box is put in world space once, so each point only costs a dot product per axis
+ */
+struct OBBSupport {
+    glm::vec3 position;
+    OrientedBox box;
+
+    explicit OBBSupport(const Collider* collider)
+            : position(collider->getPosition()), box(static_cast<const OBBCollider*>(collider)->getWorldBox()) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return box.getFurthestPoint(direction);
+    }
+};
+
+/**
+ * The support function of a CapsuleCollider
+ * The capsule is put in world space once, so each point is the end of the segment furthest in the direction plus the radius
+ */
+struct CapsuleSupport {
+    glm::vec3 position;
+    Capsule capsule;
+
+    explicit CapsuleSupport(const Collider* collider)
+            : position(collider->getPosition()), capsule(static_cast<const CapsuleCollider*>(collider)->getWorldCapsule()) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return capsule.getFurthestPoint(direction);
+    }
+};
+
+/**
+ * The support function of a triangle of a concave collider, which is already in world space
+ */
+struct TriangleSupport {
+    glm::vec3 position;
+    Triangle triangle;
+
+    explicit TriangleSupport(const Triangle& triangle)
+            : position((triangle.a + triangle.b + triangle.c) / 3.f), triangle(triangle) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return triangle.getFurthestPoint(direction);
+    }
+};
+
+/**
+ * The support function of any collider, through its virtual findFurthestPointInDirection
+ * Used for colliders that aren't one of the built-in types
+ */
+struct ColliderSupport {
+    const Collider* collider;
+    glm::vec3 position;
+
+    explicit ColliderSupport(const Collider* collider) : collider(collider), position(collider->getPosition()) {}
+
+    glm::vec3 operator()(glm::vec3 direction) const {
+        return collider->findFurthestPointInDirection(direction) + position;
+    }
+};
@@ -0,0 +1,50 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Utils/AlignedAllocator.h"
+
+/**
+ * The points of a convex shape stored as an array per component, for finding support points with SIMD
+ * Duplicate positions are removed, and the arrays are padded to a multiple of 8 with copies of the first point
+ */
+class SupportPointCloud {
+    std::vector<float, AlignedAllocator<float, 32>> xs, ys, zs;
+    size_t count = 0;
+
+public:
+    SupportPointCloud() = default;
+
+    /**
+     * Create the point cloud from the given points
+     * @param points The points to store
+     */
+    explicit SupportPointCloud(const std::vector<glm::vec3>& points);
+
+    /**
+     * Get the number of points in the cloud, not including padding
+     * @return the number of points
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Get the point at the given index
+     * @param index The index of the point
+     * @return the point
+     */
+    [[nodiscard]] glm::vec3 getPoint(size_t index) const;
+
+    /**
+     * Find the point furthest in the given direction
+     * Uses AVX2 or SSE4.1 when the CPU supports them, falling back to a scalar search otherwise
+     * If multiple points are equally far, the first one is returned
+     * @param direction The direction to search in
+     * @return The index of the furthest point, 0 if the cloud is empty
+     */
+    [[nodiscard]] size_t findFurthestPointIndex(glm::vec3 direction) const;
+};
@@ -0,0 +1,40 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include <cmath>
+
+/**
+ * A triangle in world space, the piece of concave colliders that convex colliders are tested against
+ * Triangles are two sided, a collider is pushed out of whichever side it is closest to
+ */
+struct Triangle {
+    glm::vec3 a, b, c;
+
+    /**
+     * Find the corner of the triangle furthest in the given direction
+     * @param direction The direction to search in
+     * @return The corner, in world space
+     */
+    [[nodiscard]] glm::vec3 getFurthestPoint(glm::vec3 direction) const {
+        float distanceA = glm::dot(a, direction);
+        float distanceB = glm::dot(b, direction);
+        float distanceC = glm::dot(c, direction);
+        if (distanceA >= distanceB && distanceA >= distanceC) return a;
+        return distanceB >= distanceC ? b : c;
+    }
+
+    /**
+     * Get the normal of the triangle's front face, the side its corners go anticlockwise around
+     * @return The normal, or 0 if the triangle has no area
+     */
+    [[nodiscard]] glm::vec3 getNormal() const {
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float lengthSquared = glm::dot(normal, normal);
+        return lengthSquared > 0.f ? normal / std::sqrt(lengthSquared) : glm::vec3(0);
+    }
+};
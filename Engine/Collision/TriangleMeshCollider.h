@@ -0,0 +1,115 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <Engine/FlatBVH.h>
+
+#include "Collider.h"
+#include "Triangle.h"
+
+/**
+ * A concave collider made of the triangles of a mesh, for static level geometry
+ * The triangles are kept in a bounding volume hierarchy in the collider's space, so a collision test only reaches the
+ * triangles whose bounds overlap the other collider, and each of those is tested on its own as a convex shape. The
+ * hierarchy is built when the collider is made, or can be baked to a file with saveToFile and loaded with loadFromFile.
+ * Triangle meshes aren't tested against each other, they are meant for actors that don't move.
+ */
+class TriangleMeshCollider : public Collider {
+    /** Nodes with this many triangles or fewer aren't split */
+    static constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+    /** The mesh the triangles came from, only used for drawing */
+    Mesh* mesh;
+    /** The corners of the triangles, in the collider's space */
+    std::vector<glm::vec3> positions;
+    /** 3 indices into positions for each triangle, in the order the hierarchy's leaves refer to them */
+    std::vector<uint32_t> indices;
+    /** The hierarchy of the triangles' bounds, in the collider's space */
+    FlatBVH hierarchy{MAX_LEAF_TRIANGLES};
+
+    /**
+     * Get the bounds of a triangle in the collider's space
+     * @param triangle The index of the triangle
+     * @return The bounds of the triangle
+     */
+    [[nodiscard]] BoundingBox getTriangleBounds(uint32_t triangle) const;
+
+public:
+
+    /**
+     * Make a collider from the triangles of a mesh and build its hierarchy
+     * Triangles with no area are left out, as they can't be pushed out of
+     * @param collisionMode The collision mode of the collider
+     * @param mesh The mesh, which is also drawn for the collider
+     */
+    TriangleMeshCollider(CollisionMode collisionMode, Mesh* mesh);
+
+    /**
+     * Save the triangles and the hierarchy, so they don't need building again
+     * @param filePath The path to save to
+     * @return true if the file was saved
+     */
+    bool saveToFile(const std::string& filePath) const;
+
+    /**
+     * Replace the triangles and the hierarchy with ones saved by saveToFile
+     * The mesh drawn for the collider isn't changed. If the file can't be loaded the collider is left as it was
+     * @param filePath The path to load from
+     * @return true if the file was loaded
+     */
+    bool loadFromFile(const std::string& filePath);
+
+    /**
+     * Get the number of triangles in the collider
+     * @return The number of triangles
+     */
+    [[nodiscard]] size_t getTriangleCount() const;
+
+    /**
+     * Find the triangles whose bounds overlap a bounding box
+     * @param bb The bounding box in world space
+     * @param function Called with each triangle found, in world space
+     */
+    template<typename Function>
+    void queryTriangles(const BoundingBox& bb, Function&& function) const;
+
+    /**
+     * Get the bounding box of the hierarchy as it is transformed, relative to the collider's position
+     * @inherit
+     */
+    [[nodiscard]] BoundingBox getBoundingBox() const override;
+
+    /**
+     * Find the furthest corner of any of the triangles, which is the furthest point of their convex hull
+     * This checks every corner, so is only meant for building the bounds of a CompoundCollider the mesh is part of
+     * @inherit
+     */
+    [[nodiscard]] glm::vec3 findFurthestPointInDirection(glm::vec3 direction) const override;
+
+    Mesh* getRenderMesh() override;
+
+    glm::mat4 getRenderMeshTransform() override;
+};
+
+template<typename Function>
+void TriangleMeshCollider::queryTriangles(const BoundingBox& bb, Function&& function) const {
+    glm::mat4 transform = getTransform();
+    glm::mat3 toLocal = glm::inverse(glm::mat3(transform));
+    BoundingBox localBox = bb.transformed(toLocal, -(toLocal * glm::vec3(transform[3])));
+
+    hierarchy.query(localBox, [&](uint32_t triangle) {
+        if (!getTriangleBounds(triangle).overlaps(localBox)) return;
+
+        const uint32_t* corners = &indices[triangle * 3];
+        function(Triangle{
+            glm::vec3(transform * glm::vec4(positions[corners[0]], 1)),
+            glm::vec3(transform * glm::vec4(positions[corners[1]], 1)),
+            glm::vec3(transform * glm::vec4(positions[corners[2]], 1))
+        });
+    });
+}
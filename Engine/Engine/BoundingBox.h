@@ -6,6 +6,7 @@
 
 
 #include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
 
 struct BoundingBox {
     glm::vec3 min, max;
@@ -18,4 +19,19 @@ struct BoundingBox {
 
     BoundingBox& operator=(BoundingBox&& boundingBox) = default;
     BoundingBox& operator=(const BoundingBox& boundingBox) = default;
+
+    /**
+     * Check if this bounding box overlaps another, touching boxes count as overlapping
+     * @param other The bounding box to check against
+     * @return true if the bounding boxes overlap
+     */
+    [[nodiscard]] bool overlaps(const BoundingBox& other) const;
+
+    /**
+     * Find the smallest box around this one once it is transformed, which is larger than it when the box is rotated
+     * @param matrix The rotation and scale to apply
+     * @param translation The offset to add after the matrix is applied
+     * @return The bounding box of the transformed box
+     */
+    [[nodiscard]] BoundingBox transformed(const glm::mat3& matrix, const glm::vec3& translation = glm::vec3(0)) const;
 };
@@ -0,0 +1,52 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "BoundingBox.h"
+
+/**
+ * A list of bounding boxes, stored as an array per component so that many boxes can be tested at once with SIMD
+ */
+struct BoundingBoxList {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    /**
+     * Add a bounding box to the end of the list
+     * @param bb The bounding box to add
+     */
+    void push_back(const BoundingBox& bb);
+
+    /**
+     * Remove all the bounding boxes from the list
+     */
+    void clear();
+
+    /**
+     * Get the number of bounding boxes in the list
+     * @return the number of bounding boxes in the list
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Find the bounding boxes in the list that overlap the given bounding box
+     * Tests 8 boxes at a time with AVX, or 4 at a time with SSE
+     * @param bb The bounding box to test against
+     * @param start The index of the first bounding box in the list to test
+     * @param outIndices The vector the indices of the overlapping bounding boxes will be added to
+     */
+    void getOverlapping(const BoundingBox& bb, size_t start, std::vector<uint32_t>& outIndices) const;
+
+    /**
+     * Find the bounding boxes in a range of the list that overlap the given bounding box
+     * @param bb The bounding box to test against
+     * @param start The index of the first bounding box in the list to test
+     * @param end The index after the last bounding box in the list to test
+     * @param outIndices The vector the indices of the overlapping bounding boxes will be added to
+     */
+    void getOverlapping(const BoundingBox& bb, size_t start, size_t end, std::vector<uint32_t>& outIndices) const;
+};
@@ -0,0 +1,73 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+struct Actor;
+
+/**
+ * Interface for broad phase collision detection, which finds the actors whose bounding boxes may overlap
+ * Actors are found by their world bounding boxes, so Actor#updateWorldBoundingBox must be called after an actor moves
+ */
+class BroadPhase {
+public:
+    virtual ~BroadPhase() = default;
+
+    /**
+     * Add an actor to the broad phase
+     * @param actor The actor to add
+     */
+    virtual void insertActor(Actor* actor) = 0;
+
+    /**
+     * Remove an actor from the broad phase
+     * @param actor The actor to remove
+     * @return true if the actor was removed
+     */
+    virtual bool removeActor(Actor* actor) = 0;
+
+    /**
+     * Tell the broad phase an actor's world bounding box may have changed
+     * Actors that are not yet in the broad phase are inserted
+     * @param actor The actor to update
+     * @return true if the broad phase had to restructure to fit the actor
+     */
+    virtual bool updateActor(Actor* actor) = 0;
+
+    /**
+     * Get all the actors whose bounding boxes overlap the given actor's, not including the actor itself
+     * @param actor The actor being checked for
+     * @param outVector The vector that the close actors will be added to
+     */
+    virtual void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) = 0;
+
+    /**
+     * Get every pair of actors whose collision filters let them collide and whose bounding boxes overlap
+     * Each pair is only given once, and an actor is never paired with itself
+     * @param outPairs The vector that the pairs will be added to
+     * @return The number of pairs that were tested, including the ones rejected by their bounding boxes
+     */
+    virtual size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) = 0;
+
+    /**
+     * Get all the actors in the broad phase
+     * @param outVector The vector that the actors will be added to
+     */
+    virtual void getAllActors(std::vector<Actor*>& outVector) = 0;
+
+    /**
+     * Remove all actors from the broad phase
+     */
+    virtual void clear() = 0;
+
+    /**
+     * Get the number of times the broad phase has allocated memory, which should stop going up once the scene settles
+     * @return The number of allocations so far, always 0 for broad phases that don't count them
+     */
+    [[nodiscard]] virtual size_t getAllocationCount() const { return 0; }
+};
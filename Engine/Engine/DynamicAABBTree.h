@@ -0,0 +1,143 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "BroadPhase.h"
+#include "BoundingBox.h"
+
+/**
+ * A broad phase that keeps the actors in a binary tree of bounding boxes, which grows to fit wherever the actors are
+ * The actors are stored with fattened bounding boxes, so actors that only move a little don't change the tree. The
+ * tree is kept balanced with rotations as actors are inserted, so it suits large open worlds and actors of very
+ * different sizes, which don't fit a fixed size octree.
+ */
+class DynamicAABBTree : public BroadPhase {
+    /** The smallest distance the bounds of an actor are fattened by on each side */
+    float FAT_MARGIN = 0.1f;
+    /** How much the bounds of an actor are fattened by on each side, as a fraction of their size */
+    float FAT_RATIO = 0.1f;
+
+    static constexpr int32_t NULL_NODE = -1;
+
+    struct Node {
+        /** The fattened bounds of the actor for leaves, otherwise the bounds of both children */
+        BoundingBox bounds;
+        /** The actor of a leaf, nullptr for branches */
+        Actor* actor = nullptr;
+        /** The parent of the node, or the next free node if the node isn't in use */
+        int32_t parentOrNext = NULL_NODE;
+        int32_t child1 = NULL_NODE;
+        int32_t child2 = NULL_NODE;
+        /** The height of the node above the deepest leaf below it, 0 for leaves and -1 for free nodes */
+        int32_t height = -1;
+
+        [[nodiscard]] bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    /** All the nodes, the ones not in the tree are linked together through parentOrNext */
+    std::vector<Node> nodes;
+    int32_t root = NULL_NODE;
+    int32_t freeList = NULL_NODE;
+
+    /** The nodes still to visit by a query, kept between queries so they don't allocate */
+    std::vector<int32_t> stack;
+    /** The pairs of nodes still to visit by getAllPotentialPairs */
+    std::vector<std::pair<int32_t, int32_t>> pairStack;
+
+    /**
+     * Take a node from the free list, growing the nodes if there are none left
+     * @return The index of the node
+     */
+    int32_t allocateNode();
+
+    /**
+     * Put a node back on the free list
+     * @param node The index of the node
+     */
+    void freeNode(int32_t node);
+
+    /**
+     * Add a leaf to the tree, next to the node that grows the least to fit it, then rebalance the tree above it
+     * @param leaf The index of the leaf, which must already have its bounds
+     */
+    void insertLeaf(int32_t leaf);
+
+    /**
+     * Take a leaf out of the tree, replacing its parent with its sibling
+     * @param leaf The index of the leaf
+     */
+    void removeLeaf(int32_t leaf);
+
+    /**
+     * Rotate the children of a node so the heights of its subtrees differ by at most one
+     * @param node The index of the node to balance
+     * @return The index of the node now in its place
+     */
+    int32_t balance(int32_t node);
+
+    /**
+     * Get the fattened bounds an actor is stored with
+     * @param bb The world bounding box of the actor
+     * @return The fattened bounds
+     */
+    [[nodiscard]] BoundingBox fatten(const BoundingBox& bb) const;
+
+    /**
+     * Check if the actor's proxy id is one of this tree's leaves, and that leaf is the actor
+     * @param actor The actor to check
+     * @return true if the actor is stored in this tree
+     */
+    [[nodiscard]] bool contains(const Actor* actor) const;
+
+    /**
+     * Find the leaves whose actors' bounding boxes overlap the given bounding box
+     * @param bb The world space bounding box
+     * @param function Called with the index of each leaf found
+     * @return The number of leaves whose actors' bounding boxes were tested
+     */
+    template<typename Function>
+    size_t query(const BoundingBox& bb, Function&& function);
+
+public:
+    DynamicAABBTree() = default;
+    ~DynamicAABBTree() override;
+
+    /** @inherit */
+    void insertActor(Actor* actor) override;
+
+    /**
+     * Remove the given actor from the tree
+     * This uses the proxy id stored on the actor, so doesn't need to search the tree
+     * @inherit
+     */
+    bool removeActor(Actor* actor) override;
+
+    /**
+     * Reinsert the actor if its bounding box has left its fattened bounds
+     * @inherit
+     */
+    bool updateActor(Actor* actor) override;
+
+    /** @inherit */
+    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) override;
+
+    /** @inherit */
+    void getAllActors(std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    void clear() override;
+
+    /**
+     * Get the height of the tree, the number of branches between the root and the deepest leaf
+     * @return The height of the tree, or -1 if it is empty
+     */
+    [[nodiscard]] int32_t getHeight() const;
+};
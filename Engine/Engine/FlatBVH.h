@@ -0,0 +1,135 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+
+#include "BoundingBox.h"
+
+/**
+ * A bounding volume hierarchy of items that don't move relative to each other, built by splitting at the median
+ * The nodes are stored depth first in one array, with each node's first child straight after it, so the hierarchy can
+ * be saved and loaded as a single block of memory. Each leaf is a range of the items, so the owner keeps its items in
+ * the order build gives.
+ */
+class FlatBVH {
+public:
+    /** The deepest a node can be, building halves the items at each level so a 32 bit count never goes deeper */
+    static constexpr uint32_t MAX_DEPTH = 32;
+
+    struct Node {
+        /** The bounds of all the items under the node */
+        BoundingBox bounds;
+        /** The index of the first item for leaves, otherwise the index of the second child */
+        uint32_t offset;
+        /** The number of items in a leaf, 0 for branches */
+        uint32_t count;
+    };
+
+private:
+    /** Nodes with this many items or fewer aren't split */
+    uint32_t maxLeafItems;
+    /** The nodes, the root first */
+    std::vector<Node> nodes;
+
+    /**
+     * Build the subtree for a range of the items
+     * @param bounds The bounds of every item
+     * @param centres The centre of each of bounds
+     * @param order The items in the order the leaves refer to them, reordered so each leaf's items are together
+     * @param first The index in order of the first item in the subtree
+     * @param count The number of items in the subtree
+     */
+    void buildNode(const std::vector<BoundingBox>& bounds, const std::vector<glm::vec3>& centres, std::vector<uint32_t>& order, uint32_t first, uint32_t count);
+
+public:
+    /**
+     * Make an empty hierarchy
+     * @param maxLeafItems Nodes with this many items or fewer aren't split
+     */
+    explicit FlatBVH(uint32_t maxLeafItems);
+
+    /**
+     * Build the hierarchy from scratch
+     * @param bounds The bounds of each item
+     * @param destOrder Set to the index in bounds of each item, in the order the leaves refer to them
+     */
+    void build(const std::vector<BoundingBox>& bounds, std::vector<uint32_t>& destOrder);
+
+    /**
+     * Set the bounds of every node from the bounds of its items, keeping the shape of the hierarchy
+     * @param bounds The bounds of each item, in the order the leaves refer to them
+     */
+    void refit(const std::vector<BoundingBox>& bounds);
+
+    /**
+     * Write the nodes to a stream, as a single block
+     * @param stream The stream to write to
+     */
+    void write(std::ostream& stream) const;
+
+    /**
+     * Replace the nodes with ones written by write
+     * Queries follow the offsets without checking them, so the nodes must make a hierarchy that holds every item once
+     * and that is no deeper than MAX_DEPTH
+     * @param stream The stream to read from
+     * @param nodeCount The number of nodes written
+     * @param itemCount The number of items the hierarchy was built from
+     * @return false if the nodes couldn't be read or don't make such a hierarchy, in which case it is left empty
+     */
+    bool read(std::istream& stream, uint32_t nodeCount, uint32_t itemCount);
+
+    /**
+     * Find the items in the leaves whose bounds overlap a bounding box
+     * @param bb The bounding box, in the same space as the items' bounds
+     * @param function Called with the index of each item found, in the order the leaves refer to them
+     * @return The number of items found
+     */
+    template<typename Function>
+    size_t query(const BoundingBox& bb, Function&& function) const;
+
+    /**
+     * Get the bounds of every item, the hierarchy must not be empty
+     * @return The bounds of the root
+     */
+    [[nodiscard]] const BoundingBox& getBounds() const { return nodes[0].bounds; }
+
+    [[nodiscard]] uint32_t getNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+
+    [[nodiscard]] bool empty() const { return nodes.empty(); }
+
+    void clear() { nodes.clear(); }
+};
+
+template<typename Function>
+size_t FlatBVH::query(const BoundingBox& bb, Function&& function) const {
+    if (nodes.empty()) return 0;
+
+    // Each level down leaves at most one more node on the stack
+    uint32_t stack[MAX_DEPTH + 2];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    size_t found = 0;
+    while (stackSize > 0) {
+        uint32_t index = stack[--stackSize];
+        const Node& node = nodes[index];
+        if (!node.bounds.overlaps(bb)) continue;
+
+        if (node.count == 0) {
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = index + 1;
+            continue;
+        }
+
+        found += node.count;
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+            function(i);
+        }
+    }
+    return found;
+}
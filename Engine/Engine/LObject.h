@@ -26,6 +26,9 @@ protected:
      * A pointer to an object of which this object's position, rotation, and scale is based off of
      */
     LObject* parent;
+
+    /** The object has been moved, rotated, or scaled since clearMoved was last called */
+    bool moved = true;
 public:
     LObject()
             : position({0, 0, 0}), scale({1, 1, 1}), rotation({0, 0, 0}), parent(nullptr), enableTick(true) {}
@@ -70,7 +73,7 @@ public:
      */
     [[nodiscard]] virtual const glm::mat4 getTransform() const {
         if (parent != nullptr) {
-            return getLocalTransform() * parent->getTransform();
+            return parent->getTransform() * getLocalTransform();
         } else {
             return getLocalTransform();
         }
@@ -106,6 +109,7 @@ public:
      */
     virtual void setLocalPosition(const glm::vec3& position) {
         LObject::position = position;
+        moved = true;
     }
 
     /**
@@ -130,6 +134,7 @@ public:
      */
     virtual void setLocalScale(const glm::vec3& scale) {
         LObject::scale = scale;
+        moved = true;
     }
 
     /**
@@ -146,6 +151,7 @@ public:
      */
     virtual void setLocalRotation(const glm::vec3& rotation) {
         LObject::rotation = rotation;
+        moved = true;
     }
 
     /**
@@ -154,5 +160,21 @@ public:
      */
     void setParent(LObject* parent) {
         this->parent = parent;
+        moved = true;
+    }
+
+    /**
+     * Check if the object has moved since clearMoved was last called, including by any of its parents moving
+     * @return true if the object's world transform may have changed
+     */
+    [[nodiscard]] bool hasMoved() const {
+        return moved || (parent != nullptr && parent->hasMoved());
+    }
+
+    /**
+     * Start tracking movement again from the object's current transform
+     */
+    void clearMoved() {
+        moved = false;
     }
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+#include "RebuiltBroadPhase.h"
+#include "BoundingBox.h"
+#include "Collision/Collider.h"
+
+/**
+ * An octree stored as flat arrays, rebuilt from scratch whenever anything has moved
+ * The actors are sorted by the Morton codes of their centres, which puts the actors of every octant next to each
+ * other, so each node is just a range of the sorted actors and the children of a node are stored together. Nodes are
+ * fitted to the bounds of their actors, so the tree doesn't need to know the size of the world beforehand.
+ */
+class LinearOctree : public RebuiltBroadPhase {
+    /** Nodes with this many actors or fewer aren't split */
+    uint32_t MAX_ENTITIES = 8;
+    /**
+     * The number of bits of each axis in the Morton codes, which is also the deepest a node can be
+     * 30 bit codes take half as many passes to sort as 63 bit ones, and actors closer together than a thousandth of
+     * the size of the world are rare enough to share a leaf
+     */
+    static constexpr uint32_t MORTON_BITS = 10;
+    /** The number of actors each thread takes at a time */
+    static constexpr size_t ACTORS_PER_CHUNK = 4096;
+    /** A query pushes at most 8 children for each level it descends */
+    static constexpr size_t QUERY_STACK_SIZE = 8 * (MORTON_BITS + 1);
+
+    struct Node {
+        /** The bounds of all the actors in the node */
+        BoundingBox bounds;
+        /** The index of the node's first actor in the sorted actors */
+        uint32_t first;
+        uint32_t count;
+        /** The index of the node's first child, the rest follow it */
+        uint32_t firstChild = 0;
+        /** The number of children, 0 for leaves */
+        uint32_t childCount = 0;
+        /** The number of bits of each axis of the Morton codes that all the node's actors share */
+        uint32_t level;
+    };
+
+    /** The world bounding box of each actor when the octree was last built, in the same order as actors */
+    std::vector<BoundingBox> bounds;
+    /** The centre of each actor's bounds, in the same order as actors */
+    std::vector<glm::vec3> centres;
+    /** The bounds of the centres of each chunk of actors */
+    std::vector<BoundingBox> chunkBounds;
+
+    /** The Morton code of each actor, then sorted */
+    std::vector<uint32_t> codes;
+    /** The index in actors of each of codes */
+    std::vector<uint32_t> order;
+    /** Space for the radix sort to put the next order in */
+    std::vector<uint32_t> codesBuffer;
+    std::vector<uint32_t> orderBuffer;
+    /** The number of keys with each digit, for each chunk of the keys */
+    std::vector<uint32_t> histograms;
+
+    /** The actors in Morton order, along with their bounds and filters */
+    std::vector<Actor*> sortedActors;
+    std::vector<BoundingBox> sortedBounds;
+    std::vector<CollisionFilter> sortedFilters;
+
+    /** The nodes, with the root first and the children of each node together */
+    std::vector<Node> nodes;
+
+    /**
+     * Sort codes, and order along with them, with a least significant digit radix sort
+     * Each pass counts the digits of each chunk of keys in parallel, then each chunk moves its keys in parallel
+     */
+    void sortCodes();
+
+    /**
+     * Split the sorted actors into nodes
+     */
+    void buildNodes();
+
+    /**
+     * Sort the actors and build the nodes again, if anything has changed
+     */
+    void rebuild();
+
+    /**
+     * Find the sorted actors whose bounds overlap the given bounding box
+     * Safe to call from several threads at once
+     * @param bb The world space bounding box
+     * @param first The index in the sorted actors of the first actor to test, actors before it are skipped
+     * @param function Called with the index in the sorted actors of each actor found
+     * @return The number of actors whose bounds were tested
+     */
+    template<typename Function>
+    size_t query(const BoundingBox& bb, uint32_t first, Function&& function) const;
+
+public:
+    /**
+     * @param threadPool The thread pool to sort the actors and find pairs with, or nullptr to do it all on the calling
+     * thread. Must outlive the octree.
+     */
+    explicit LinearOctree(ThreadPool* threadPool = nullptr);
+
+    /** @inherit */
+    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) override;
+
+    /** @inherit */
+    void clear() override;
+};
@@ -4,18 +4,63 @@
 
 #pragma once
 #include <vector>
+#include <memory>
 #include <glm/glm.hpp>
 #include <algorithm>
 #include "Scene/Actor/Actor.h"
+#include "BoundingBoxList.h"
+#include "BroadPhase.h"
+
+class Octree : public BroadPhase {
+    static constexpr int MAX_DEPTH = 8;
+    size_t MAX_ENTITIES = 8;
+    /** A query pushes at most 8 octants for each level it descends, and the tree is at most MAX_DEPTH deep */
+    static constexpr size_t QUERY_STACK_SIZE = 8 * (MAX_DEPTH + 1);
+
+    /** The octants of one octree, allocated together, defined in Octree.cpp */
+    struct OctantBlock;
+    /** The octant blocks of a tree and the buffers its queries reuse, owned by the root, defined in Octree.cpp */
+    struct Pool;
 
-class Octree {
-    int MAX_DEPTH = 8;
     std::vector<Actor*> entities;
-    std::vector<Octree*> subTrees;
+    /** The 8 octants of this octree, in the order of the octant indices, or nullptr if it hasn't been split */
+    OctantBlock* block = nullptr;
     int depth;
     glm::vec3 position;
     glm::vec3 dimensions;
 
+    /** The pool of the whole tree, only set on the root */
+    std::unique_ptr<Pool> ownedPool;
+    /** The pool the octants of this tree are taken from */
+    Pool* pool;
+
+    /** The octree this octree is an octant of, nullptr for the root */
+    Octree* parent = nullptr;
+    /** The number of actors stored in this octree and all of its octants */
+    size_t actorCount = 0;
+
+    /**
+     * The region an actor's bounding box must lie strictly within to be stored in this octree
+     * This is bounded by the centres of the parent octrees, rather than the dimensions, as actors that stick out of the
+     * root are still stored in the octant they lean towards
+     */
+    glm::vec3 regionMin, regionMax;
+
+    /**
+     * Create an octant that hasn't been placed yet, the octants are placed by spill
+     */
+    Octree();
+
+    /**
+     * Place an octant of the given octree
+     * @param dimensions The half size of the octant
+     * @param position The centre of the octant
+     * @param parent The octree this is an octant of
+     * @param regionMin The minimum of the region actors stored in this octant must lie within
+     * @param regionMax The maximum of the region actors stored in this octant must lie within
+     */
+    void placeOctant(glm::vec3 dimensions, glm::vec3 position, Octree* parent, glm::vec3 regionMin, glm::vec3 regionMax);
+
 protected:
     int BOTTOMFRONTRIGHTINDEX = 0;
     int BOTTOMFRONTLEFINDEX = 1;
@@ -27,19 +72,18 @@ protected:
     int TOPBACKLEFTINDEX = 7;
 
     /**
-     * Calculate the octant the actor is in
-     * @param actor
-     * @return the index of the octant if the actor's bounding box is contained wholly in
+     * Calculate the octant the bounding box is in
+     * @param bb The world space bounding box
+     * @return the index of the octant if the bounding box is contained wholly in one, otherwise -1
      */
-    int getBoundingBoxOctant(glm::vec3 bbPosition, const BoundingBox& bb);
+    int getBoundingBoxOctant(const BoundingBox& bb);
 
     /**
-     * Get all the quadrants overlapped by the bounding box
-     * @param bbPosition the position of the bounding box
-     * @param bbSize the dimensions of the bounding box
-     * @param outOctants The vector the octants will be added to
+     * Get all the octants overlapped by the bounding box
+     * @param bb The world space bounding box
+     * @return A mask with the bit of each overlapped octant's index set
      */
-    void getAllOverlappedOctants(glm::vec3 bbPosition, const BoundingBox& bb, std::vector<Octree*>& outOctants);
+    [[nodiscard]] uint8_t getOverlappedOctants(const BoundingBox& bb) const;
 
     /**
      * Get the octant the given point is withing
@@ -49,18 +93,63 @@ protected:
     int getPointOctant(glm::vec3 point);
 
     /**
-     * Create the octants and spill each actor into their relevant ones
+     * Check if the given bounding box belongs in this octree
+     * @param bb The world space bounding box
+     * @return true if the bounding box is within the region of this octree
+     */
+    [[nodiscard]] bool isInRegion(const BoundingBox& bb) const;
+
+    /**
+     * Check if the given bounding box overlaps the region of this octree
+     * @param bb The world space bounding box
+     * @return true if any part of the bounding box is within the region of this octree
+     */
+    [[nodiscard]] bool overlapsRegion(const BoundingBox& bb) const;
+
+    /**
+     * Get the pairs of actors in this octree whose bounding boxes overlap, including pairs with the actors stored
+     * further up the tree
+     * The buffers used at each depth are kept in the pool, so this doesn't allocate once they are big enough
+     * @param ancestorActors The actors stored further up the tree that overlap this octree
+     * @param ancestorBounds The world space bounding boxes of ancestorActors
+     * @param ancestorFilters The collision filters of ancestorActors
+     * @param outPairs The vector the pairs will be added to
+     * @return The number of pairs that were tested, including the ones rejected by their bounding boxes
+     */
+    size_t getPotentialPairs(const std::vector<Actor*>& ancestorActors, const BoundingBoxList& ancestorBounds,
+                             const std::vector<CollisionFilter>& ancestorFilters,
+                             std::vector<std::pair<Actor*, Actor*>>& outPairs);
+
+    /**
+     * Take a block of octants from the pool and spill each actor into their relevant ones
      */
     void spill();
 
+    /**
+     * Give the octants of this octree, and all of theirs, back to the pool
+     * The octants must not have any actors
+     */
+    void releaseOctants();
+
+    /**
+     * Remove the actor from the entities of the octree it is stored in and update the actor counts, without merging
+     * any octants
+     * @param actor The actor to detach
+     */
+    static void detachActor(Actor* actor);
+
+    /**
+     * Delete the octants of the highest ancestor of this octree whose octants no longer contain any actors
+     */
+    void mergeEmptyOctants();
+
 public:
 
-    Octree(glm::vec3 dimensions, glm::vec3 position, int depth=0) : dimensions(dimensions), position(position), depth(depth) {};
-    ~Octree() {
-        for (Octree* subTree : this->subTrees) {
-            delete subTree;
-        }
-    }
+    Octree(glm::vec3 dimensions, glm::vec3 position, int depth=0);
+    ~Octree() override;
+
+    Octree(const Octree&) = delete;
+    Octree& operator=(const Octree&) = delete;
 
     /**
      * Insert an actor into the octree
@@ -68,37 +157,45 @@ public:
      */
     void insertNode(Actor* actor);
 
-    /**
-     * Get all the actors close to the given actor
-     * @param actor The actor being checked for
-     * @param outVector The vector that the close actors will be added to
-     */
-    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector);
+    /** @inherit */
+    void insertActor(Actor* actor) override;
 
     /**
-     * Get all the actors in the octree
-     * @param outVector
+     * Move the actor to the octree its bounding box now belongs in, if it has left the one it is stored in
+     * Actors that are not yet in the tree are inserted
+     * @param actor The actor to update
+     * @return true if the actor was moved
      */
-    void getAllActors(std::vector<Actor*>& outVector);
+    bool updateActor(Actor* actor) override;
+
+    /** @inherit */
+    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) override;
+
+    /** @inherit */
+    void getAllActors(std::vector<Actor*>& outVector) override;
 
     /**
      * Remove the given actor from the octree
-     * This operation parses the whole octree and thus can be expensive
+     * This uses the octree stored on the actor, so doesn't need to search the tree
      * @param actor The actor to remove
      * @return true if the actor was removed
      */
-    bool removeActor(Actor* actor);
+    bool removeActor(Actor* actor) override;
 
     /**
-     * Remove the given actor from the octree, giving it's location as of when it was inserted in the tree
-     * @param actor The actor to remove
-     * @param positionHint The position of the actor when it was inserted
-     * @return true if the actor was removed
+     * Remove all actors and subtrees from this Octree
      */
-    bool removeActor(Actor* actor, glm::vec3 positionHint);
+    void clearTree();
+
+    /** @inherit */
+    void clear() override;
 
     /**
-     * Remove all actors and subtrees from this Octree
+     * Counts the octant blocks taken from the heap, and every time a list of actors or a query buffer had to grow
+     * @inherit
      */
-    void clearTree();
+    [[nodiscard]] size_t getAllocationCount() const override;
 };
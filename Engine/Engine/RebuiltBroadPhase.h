@@ -0,0 +1,102 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "BroadPhase.h"
+#include "Collision/Collider.h"
+
+class ThreadPool;
+
+/**
+ * A broad phase that keeps its actors in a list and rebuilds its spatial index of them from scratch, the next time it
+ * is needed after any actor has been inserted, removed or moved
+ * This keeps the list and the parallel loops, so subclasses only build and search their index.
+ */
+class RebuiltBroadPhase : public BroadPhase {
+    /** The pairs found by each chunk, so they can be joined in order */
+    std::vector<std::vector<std::pair<Actor*, Actor*>>> chunkPairs;
+    std::vector<size_t> chunkCandidates;
+
+protected:
+    ThreadPool* threadPool;
+    /** The number of iterations each thread takes at a time */
+    const size_t chunkSize;
+
+    /** The actors in the broad phase, each actor's broadPhaseProxy is its index in this */
+    std::vector<Actor*> actors;
+
+    /** If any actor has been inserted, removed or moved since the index was last rebuilt */
+    bool dirty = false;
+
+    /**
+     * @param threadPool The thread pool to run loops on, or nullptr to run them on the calling thread
+     * @param chunkSize The number of iterations each thread takes at a time
+     */
+    RebuiltBroadPhase(ThreadPool* threadPool, size_t chunkSize);
+
+    /**
+     * Check if the actor's proxy id is its index in actors
+     * @param actor The actor to check
+     * @return true if the actor is stored in this broad phase
+     */
+    [[nodiscard]] bool contains(const Actor* actor) const;
+
+    /**
+     * Run a loop on the thread pool, or on this thread if there isn't one
+     * @param count The number of iterations in the loop
+     * @param function The function to run on each chunk, given the first iteration and one past the last
+     */
+    void forEachChunk(size_t count, const std::function<void(size_t begin, size_t end)>& function);
+
+    /**
+     * Read the collision filter of each actor
+     * Filters can change without the actor moving, so they are read again every time pairs are found
+     * @param sourceActors The actors to read the filters of
+     * @param destFilters Set to the filter of each of sourceActors
+     */
+    void readFilters(const std::vector<Actor*>& sourceActors, std::vector<CollisionFilter>& destFilters);
+
+    /**
+     * Find pairs in parallel, each chunk keeping its pairs apart from the rest so they come out in the same order every
+     * time however the chunks are spread over the threads
+     * @param count The number of iterations in the loop
+     * @param function Finds the pairs for a chunk, given the first iteration, one past the last, and the vector to add
+     * the pairs to. Returns the number of pairs it tested.
+     * @param outPairs The vector the pairs of every chunk are added to, in chunk order
+     * @return The number of pairs tested by every chunk
+     */
+    size_t findPairsInChunks(size_t count, const std::function<size_t(size_t begin, size_t end, std::vector<std::pair<Actor*, Actor*>>& pairs)>& function,
+                             std::vector<std::pair<Actor*, Actor*>>& outPairs);
+
+public:
+    /** @inherit */
+    void insertActor(Actor* actor) override;
+
+    /**
+     * Remove the given actor
+     * This uses the proxy id stored on the actor, so doesn't need to search for it
+     * @inherit
+     */
+    bool removeActor(Actor* actor) override;
+
+    /**
+     * The index is only rebuilt when it is next needed, so this only marks it out of date
+     * @inherit
+     */
+    bool updateActor(Actor* actor) override;
+
+    /** @inherit */
+    void getAllActors(std::vector<Actor*>& outVector) override;
+
+    /**
+     * Remove every actor, subclasses also clear their index
+     * @inherit
+     */
+    void clear() override;
+};
@@ -4,6 +4,21 @@
 
 #include "Engine/BoundingBox.h"
 
+#include <glm/glm.hpp>
+
 BoundingBox::BoundingBox(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
 
 BoundingBox::BoundingBox(const BoundingBox& boundingBox) : min(boundingBox.min), max(boundingBox.max) {}
+
+bool BoundingBox::overlaps(const BoundingBox& other) const {
+    return min.x <= other.max.x && other.min.x <= max.x
+        && min.y <= other.max.y && other.min.y <= max.y
+        && min.z <= other.max.z && other.min.z <= max.z;
+}
+
+BoundingBox BoundingBox::transformed(const glm::mat3& matrix, const glm::vec3& translation) const {
+    glm::vec3 centre = matrix * ((min + max) * .5f) + translation;
+    glm::vec3 halfExtents = (max - min) * .5f;
+    glm::vec3 newHalfExtents = glm::abs(matrix[0]) * halfExtents.x + glm::abs(matrix[1]) * halfExtents.y + glm::abs(matrix[2]) * halfExtents.z;
+    return {centre - newHalfExtents, centre + newHalfExtents};
+}
@@ -0,0 +1,89 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/BoundingBoxList.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+void BoundingBoxList::push_back(const BoundingBox& bb) {
+    minX.push_back(bb.min.x);
+    minY.push_back(bb.min.y);
+    minZ.push_back(bb.min.z);
+    maxX.push_back(bb.max.x);
+    maxY.push_back(bb.max.y);
+    maxZ.push_back(bb.max.z);
+}
+
+void BoundingBoxList::clear() {
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+}
+
+size_t BoundingBoxList::size() const {
+    return minX.size();
+}
+
+void BoundingBoxList::getOverlapping(const BoundingBox& bb, size_t start, std::vector<uint32_t>& outIndices) const {
+    getOverlapping(bb, start, size(), outIndices);
+}
+
+void BoundingBoxList::getOverlapping(const BoundingBox& bb, size_t start, size_t end, std::vector<uint32_t>& outIndices) const {
+    size_t i = start;
+    const size_t count = end;
+
+#if defined(__AVX__)
+    const __m256 bbMinX = _mm256_set1_ps(bb.min.x), bbMinY = _mm256_set1_ps(bb.min.y), bbMinZ = _mm256_set1_ps(bb.min.z);
+    const __m256 bbMaxX = _mm256_set1_ps(bb.max.x), bbMaxY = _mm256_set1_ps(bb.max.y), bbMaxZ = _mm256_set1_ps(bb.max.z);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 overlap = _mm256_and_ps(
+                _mm256_cmp_ps(_mm256_loadu_ps(&minX[i]), bbMaxX, _CMP_LE_OQ),
+                _mm256_cmp_ps(bbMinX, _mm256_loadu_ps(&maxX[i]), _CMP_LE_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(&minY[i]), bbMaxY, _CMP_LE_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(bbMinY, _mm256_loadu_ps(&maxY[i]), _CMP_LE_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(_mm256_loadu_ps(&minZ[i]), bbMaxZ, _CMP_LE_OQ));
+        overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(bbMinZ, _mm256_loadu_ps(&maxZ[i]), _CMP_LE_OQ));
+
+        int mask = _mm256_movemask_ps(overlap);
+        for (int bit = 0; bit < 8; ++bit) {
+            if (mask & (1 << bit)) outIndices.push_back(static_cast<uint32_t>(i + bit));
+        }
+    }
+#elif defined(__SSE__) || defined(_M_X64)
+    const __m128 bbMinX = _mm_set1_ps(bb.min.x), bbMinY = _mm_set1_ps(bb.min.y), bbMinZ = _mm_set1_ps(bb.min.z);
+    const __m128 bbMaxX = _mm_set1_ps(bb.max.x), bbMaxY = _mm_set1_ps(bb.max.y), bbMaxZ = _mm_set1_ps(bb.max.z);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 overlap = _mm_and_ps(
+                _mm_cmple_ps(_mm_loadu_ps(&minX[i]), bbMaxX),
+                _mm_cmple_ps(bbMinX, _mm_loadu_ps(&maxX[i])));
+        overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(&minY[i]), bbMaxY));
+        overlap = _mm_and_ps(overlap, _mm_cmple_ps(bbMinY, _mm_loadu_ps(&maxY[i])));
+        overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(&minZ[i]), bbMaxZ));
+        overlap = _mm_and_ps(overlap, _mm_cmple_ps(bbMinZ, _mm_loadu_ps(&maxZ[i])));
+
+        int mask = _mm_movemask_ps(overlap);
+        for (int bit = 0; bit < 4; ++bit) {
+            if (mask & (1 << bit)) outIndices.push_back(static_cast<uint32_t>(i + bit));
+        }
+    }
+#endif
+
+    // Scalar tail, and fallback for platforms without SSE
+    for (; i < count; ++i) {
+        if (minX[i] <= bb.max.x && bb.min.x <= maxX[i]
+            && minY[i] <= bb.max.y && bb.min.y <= maxY[i]
+            && minZ[i] <= bb.max.z && bb.min.z <= maxZ[i]) {
+            outIndices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,345 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/DynamicAABBTree.h"
+#include "Scene/Actor/Actor.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    BoundingBox combine(const BoundingBox& a, const BoundingBox& b) {
+        return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+    }
+
+    /** Half the surface area of the box, the chance of a random ray hitting it is proportional to this */
+    float getCost(const BoundingBox& bb) {
+        glm::vec3 size = bb.max - bb.min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    bool encloses(const BoundingBox& outer, const BoundingBox& inner) {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+               && inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+    }
+}
+
+DynamicAABBTree::~DynamicAABBTree() {
+    clear();
+}
+
+int32_t DynamicAABBTree::allocateNode() {
+    if (freeList == NULL_NODE) {
+        // Double the nodes, linking all the new ones into the free list
+        size_t oldSize = nodes.size();
+        nodes.resize(std::max<size_t>(16, oldSize * 2));
+        for (size_t i = oldSize; i < nodes.size(); ++i) {
+            nodes[i].parentOrNext = i + 1 < nodes.size() ? static_cast<int32_t>(i + 1) : NULL_NODE;
+            nodes[i].height = -1;
+        }
+        freeList = static_cast<int32_t>(oldSize);
+    }
+
+    int32_t node = freeList;
+    freeList = nodes[node].parentOrNext;
+    nodes[node] = Node();
+    nodes[node].height = 0;
+    return node;
+}
+
+void DynamicAABBTree::freeNode(int32_t node) {
+    nodes[node].actor = nullptr;
+    nodes[node].parentOrNext = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+BoundingBox DynamicAABBTree::fatten(const BoundingBox& bb) const {
+    glm::vec3 margin = glm::max(glm::vec3(FAT_MARGIN), (bb.max - bb.min) * FAT_RATIO);
+    return {bb.min - margin, bb.max + margin};
+}
+
+bool DynamicAABBTree::contains(const Actor* actor) const {
+    int32_t proxy = actor->broadPhaseProxy;
+    return proxy >= 0 && static_cast<size_t>(proxy) < nodes.size() && nodes[proxy].actor == actor;
+}
+
+void DynamicAABBTree::insertLeaf(int32_t leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parentOrNext = NULL_NODE;
+        return;
+    }
+
+    // Walk down to the node that costs the least to pair the leaf with, by the surface area it adds to the tree
+    const BoundingBox leafBounds = nodes[leaf].bounds;
+    int32_t sibling = root;
+    while (!nodes[sibling].isLeaf()) {
+        const Node& node = nodes[sibling];
+        float area = getCost(node.bounds);
+        float combinedArea = getCost(combine(node.bounds, leafBounds));
+
+        // Pairing with this node makes a new parent for both, and every ancestor grows to fit the leaf either way
+        float cost = 2 * combinedArea;
+        float inheritedCost = 2 * (combinedArea - area);
+
+        auto getChildCost = [&](int32_t child) {
+            float childCost = getCost(combine(nodes[child].bounds, leafBounds));
+            if (!nodes[child].isLeaf()) childCost -= getCost(nodes[child].bounds);
+            return childCost + inheritedCost;
+        };
+        float cost1 = getChildCost(node.child1);
+        float cost2 = getChildCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        sibling = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    // Replace the sibling with a new parent of both
+    int32_t oldParent = nodes[sibling].parentOrNext;
+    int32_t newParent = allocateNode();
+    nodes[newParent].parentOrNext = oldParent;
+    nodes[newParent].bounds = combine(leafBounds, nodes[sibling].bounds);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parentOrNext = newParent;
+    nodes[leaf].parentOrNext = newParent;
+
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    } else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    } else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    // Refit the ancestors, balancing them on the way up
+    for (int32_t node = newParent; node != NULL_NODE; node = nodes[node].parentOrNext) {
+        node = balance(node);
+
+        const Node& child1 = nodes[nodes[node].child1];
+        const Node& child2 = nodes[nodes[node].child2];
+        nodes[node].height = 1 + std::max(child1.height, child2.height);
+        nodes[node].bounds = combine(child1.bounds, child2.bounds);
+    }
+}
+
+void DynamicAABBTree::removeLeaf(int32_t leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    int32_t parent = nodes[leaf].parentOrNext;
+    int32_t grandParent = nodes[parent].parentOrNext;
+    int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    freeNode(parent);
+    nodes[sibling].parentOrNext = grandParent;
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        return;
+    }
+
+    if (nodes[grandParent].child1 == parent) {
+        nodes[grandParent].child1 = sibling;
+    } else {
+        nodes[grandParent].child2 = sibling;
+    }
+
+    for (int32_t node = grandParent; node != NULL_NODE; node = nodes[node].parentOrNext) {
+        node = balance(node);
+
+        const Node& child1 = nodes[nodes[node].child1];
+        const Node& child2 = nodes[nodes[node].child2];
+        nodes[node].height = 1 + std::max(child1.height, child2.height);
+        nodes[node].bounds = combine(child1.bounds, child2.bounds);
+    }
+}
+
+int32_t DynamicAABBTree::balance(int32_t a) {
+    if (nodes[a].isLeaf() || nodes[a].height < 2) return a;
+
+    int32_t b = nodes[a].child1;
+    int32_t c = nodes[a].child2;
+    int32_t heightDifference = nodes[c].height - nodes[b].height;
+    if (std::abs(heightDifference) <= 1) return a;
+
+    // Lift the taller child into a's place, and move a down to be one of its children
+    int32_t up = heightDifference > 0 ? c : b;
+    int32_t other = heightDifference > 0 ? b : c;
+    int32_t f = nodes[up].child1;
+    int32_t g = nodes[up].child2;
+
+    nodes[up].child1 = a;
+    nodes[up].parentOrNext = nodes[a].parentOrNext;
+    nodes[a].parentOrNext = up;
+
+    int32_t upParent = nodes[up].parentOrNext;
+    if (upParent == NULL_NODE) {
+        root = up;
+    } else if (nodes[upParent].child1 == a) {
+        nodes[upParent].child1 = up;
+    } else {
+        nodes[upParent].child2 = up;
+    }
+
+    // The taller of the lifted child's children stays with it, the shorter goes to a in its place
+    int32_t keep = nodes[f].height > nodes[g].height ? f : g;
+    int32_t give = keep == f ? g : f;
+
+    nodes[up].child2 = keep;
+    if (heightDifference > 0) {
+        nodes[a].child2 = give;
+    } else {
+        nodes[a].child1 = give;
+    }
+    nodes[give].parentOrNext = a;
+
+    nodes[a].bounds = combine(nodes[other].bounds, nodes[give].bounds);
+    nodes[a].height = 1 + std::max(nodes[other].height, nodes[give].height);
+    nodes[up].bounds = combine(nodes[a].bounds, nodes[keep].bounds);
+    nodes[up].height = 1 + std::max(nodes[a].height, nodes[keep].height);
+
+    return up;
+}
+
+template<typename Function>
+size_t DynamicAABBTree::query(const BoundingBox& bb, Function&& function) {
+    if (root == NULL_NODE) return 0;
+
+    size_t tested = 0;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        int32_t index = stack.back();
+        stack.pop_back();
+
+        if (!node.bounds.overlaps(bb)) continue;
+
+        if (node.isLeaf()) {
+            // The fattened bounds only say the actor might overlap, so check its actual bounds
+            ++tested;
+            if (node.actor->getWorldBoundingBox().overlaps(bb)) function(index);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+    return tested;
+}
+
+void DynamicAABBTree::insertActor(Actor* actor) {
+    if (contains(actor)) return;
+
+    int32_t leaf = allocateNode();
+    nodes[leaf].actor = actor;
+    nodes[leaf].bounds = fatten(actor->getWorldBoundingBox());
+    actor->broadPhaseProxy = leaf;
+
+    insertLeaf(leaf);
+}
+
+bool DynamicAABBTree::removeActor(Actor* actor) {
+    if (!contains(actor)) return false;
+
+    int32_t leaf = actor->broadPhaseProxy;
+    removeLeaf(leaf);
+    freeNode(leaf);
+    actor->broadPhaseProxy = NULL_NODE;
+    return true;
+}
+
+bool DynamicAABBTree::updateActor(Actor* actor) {
+    if (!contains(actor)) {
+        insertActor(actor);
+        return true;
+    }
+
+    int32_t leaf = actor->broadPhaseProxy;
+    const BoundingBox& bb = actor->getWorldBoundingBox();
+    if (encloses(nodes[leaf].bounds, bb)) return false;
+
+    removeLeaf(leaf);
+    nodes[leaf].bounds = fatten(bb);
+    insertLeaf(leaf);
+    return true;
+}
+
+void DynamicAABBTree::getCloseActors(Actor* actor, std::vector<Actor*>& outVector) {
+    query(actor->getWorldBoundingBox(), [&](int32_t leaf) {
+        if (nodes[leaf].actor != actor) outVector.push_back(nodes[leaf].actor);
+    });
+}
+
+size_t DynamicAABBTree::getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    if (root == NULL_NODE) return 0;
+
+    // Descend the tree against itself, so each overlapping pair of subtrees is only found once. A node paired with
+    // itself stands for the pairs within it.
+    size_t candidates = 0;
+    pairStack.clear();
+    pairStack.emplace_back(root, root);
+    while (!pairStack.empty()) {
+        auto [a, b] = pairStack.back();
+        pairStack.pop_back();
+        const Node& nodeA = nodes[a];
+        const Node& nodeB = nodes[b];
+
+        if (a == b) {
+            if (nodeA.isLeaf()) continue;
+            pairStack.emplace_back(nodeA.child1, nodeA.child1);
+            pairStack.emplace_back(nodeA.child2, nodeA.child2);
+            pairStack.emplace_back(nodeA.child1, nodeA.child2);
+            continue;
+        }
+
+        if (!nodeA.bounds.overlaps(nodeB.bounds)) continue;
+
+        if (nodeA.isLeaf() && nodeB.isLeaf()) {
+            if (!nodeA.actor->getCollisionFilter().canCollideWith(nodeB.actor->getCollisionFilter())) continue;
+
+            // The fattened bounds only say the actors might overlap, so check their actual bounds
+            ++candidates;
+            if (nodeA.actor->getWorldBoundingBox().overlaps(nodeB.actor->getWorldBoundingBox())) {
+                outPairs.emplace_back(nodeA.actor, nodeB.actor);
+            }
+            continue;
+        }
+
+        // Split the larger node, so both sides shrink together
+        if (nodeB.isLeaf() || (!nodeA.isLeaf() && getCost(nodeA.bounds) >= getCost(nodeB.bounds))) {
+            pairStack.emplace_back(nodeA.child1, b);
+            pairStack.emplace_back(nodeA.child2, b);
+        } else {
+            pairStack.emplace_back(a, nodeB.child1);
+            pairStack.emplace_back(a, nodeB.child2);
+        }
+    }
+    return candidates;
+}
+
+void DynamicAABBTree::getAllActors(std::vector<Actor*>& outVector) {
+    for (const Node& node: nodes) {
+        if (node.height == 0) outVector.push_back(node.actor);
+    }
+}
+
+void DynamicAABBTree::clear() {
+    for (const Node& node: nodes) {
+        if (node.height == 0) node.actor->broadPhaseProxy = NULL_NODE;
+    }
+    nodes.clear();
+    stack.clear();
+    pairStack.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+}
+
+int32_t DynamicAABBTree::getHeight() const {
+    return root == NULL_NODE ? -1 : nodes[root].height;
+}
@@ -0,0 +1,117 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/FlatBVH.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <limits>
+
+FlatBVH::FlatBVH(uint32_t maxLeafItems) : maxLeafItems(maxLeafItems) {}
+
+void FlatBVH::buildNode(const std::vector<BoundingBox>& bounds, const std::vector<glm::vec3>& centres, std::vector<uint32_t>& order, uint32_t first, uint32_t count) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({bounds[order[first]], first, count});
+
+    glm::vec3 centreMin = centres[order[first]];
+    glm::vec3 centreMax = centreMin;
+    for (uint32_t i = first; i < first + count; ++i) {
+        uint32_t item = order[i];
+        nodes[index].bounds.min = glm::min(nodes[index].bounds.min, bounds[item].min);
+        nodes[index].bounds.max = glm::max(nodes[index].bounds.max, bounds[item].max);
+        centreMin = glm::min(centreMin, centres[item]);
+        centreMax = glm::max(centreMax, centres[item]);
+    }
+    if (count <= maxLeafItems) return;
+
+    // Split at the median along the axis the centres are most spread out on, which keeps the tree balanced
+    glm::vec3 extent = centreMax - centreMin;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    uint32_t half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                     [&](uint32_t a, uint32_t b) { return centres[a][axis] < centres[b][axis]; });
+
+    nodes[index].count = 0;
+    buildNode(bounds, centres, order, first, half);
+    nodes[index].offset = static_cast<uint32_t>(nodes.size());
+    buildNode(bounds, centres, order, first + half, count - half);
+}
+
+void FlatBVH::build(const std::vector<BoundingBox>& bounds, std::vector<uint32_t>& destOrder) {
+    nodes.clear();
+    destOrder.resize(bounds.size());
+    for (uint32_t i = 0; i < destOrder.size(); ++i) {
+        destOrder[i] = i;
+    }
+    if (bounds.empty()) return;
+
+    std::vector<glm::vec3> centres;
+    centres.reserve(bounds.size());
+    for (const BoundingBox& box: bounds) {
+        centres.push_back((box.min + box.max) * .5f);
+    }
+
+    // A tree split in half each time has fewer than twice as many nodes as leaves
+    nodes.reserve(2 * (bounds.size() / maxLeafItems + 1));
+    buildNode(bounds, centres, destOrder, 0, static_cast<uint32_t>(bounds.size()));
+}
+
+void FlatBVH::refit(const std::vector<BoundingBox>& bounds) {
+    // Children always come after their parents, so going backwards reaches every child before its parent
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.count == 0) {
+            const BoundingBox& first = nodes[i + 1].bounds;
+            const BoundingBox& second = nodes[node.offset].bounds;
+            node.bounds = {glm::min(first.min, second.min), glm::max(first.max, second.max)};
+            continue;
+        }
+
+        node.bounds = bounds[node.offset];
+        for (uint32_t item = node.offset + 1; item < node.offset + node.count; ++item) {
+            node.bounds.min = glm::min(node.bounds.min, bounds[item].min);
+            node.bounds.max = glm::max(node.bounds.max, bounds[item].max);
+        }
+    }
+}
+
+void FlatBVH::write(std::ostream& stream) const {
+    stream.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(Node)));
+}
+
+bool FlatBVH::read(std::istream& stream, uint32_t nodeCount, uint32_t itemCount) {
+    nodes.clear();
+    if (nodeCount > 2 * static_cast<uint64_t>(itemCount) || (itemCount > 0 && nodeCount == 0)) return false;
+
+    nodes.resize(nodeCount);
+    stream.read(reinterpret_cast<char*>(nodes.data()), static_cast<std::streamsize>(nodeCount * sizeof(Node)));
+    bool valid = static_cast<bool>(stream);
+
+    // Every node must be reached from the root exactly once, no deeper than the query stack allows, and the leaves must
+    // hold every item once and in order. Children always come after their parents, so a node's depth is known by the
+    // time it is checked.
+    const uint32_t unreached = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> depths(nodeCount, unreached);
+    if (nodeCount > 0) depths[0] = 0;
+    uint32_t nextItem = 0;
+    for (size_t i = 0; valid && i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        valid = depths[i] <= MAX_DEPTH && (node.count == 0 ? node.offset > i + 1 && node.offset < nodeCount
+                                                           : node.offset == nextItem && node.count <= itemCount - nextItem);
+        if (valid && node.count == 0) {
+            for (uint32_t child: {static_cast<uint32_t>(i + 1), node.offset}) {
+                valid = valid && depths[child] == unreached;
+                depths[child] = depths[i] + 1;
+            }
+        } else if (valid) {
+            nextItem += node.count;
+        }
+    }
+    valid = valid && nextItem == itemCount;
+
+    if (!valid) nodes.clear();
+    return valid;
+}
@@ -0,0 +1,252 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/LinearOctree.h"
+#include "Scene/Actor/Actor.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace {
+    /**
+     * Spread the lowest 10 bits of a value out so there are two zero bits between each of them
+     */
+    uint32_t spreadBits(uint32_t value) {
+        uint32_t x = std::min(value, 0x3ffu);
+        x = (x | x << 16) & 0x030000ffu;
+        x = (x | x << 8) & 0x0300f00fu;
+        x = (x | x << 4) & 0x030c30c3u;
+        x = (x | x << 2) & 0x09249249u;
+        return x;
+    }
+
+    BoundingBox combine(const BoundingBox& a, const BoundingBox& b) {
+        return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+    }
+}
+
+LinearOctree::LinearOctree(ThreadPool* threadPool) : RebuiltBroadPhase(threadPool, ACTORS_PER_CHUNK) {}
+
+void LinearOctree::sortCodes() {
+    constexpr size_t DIGIT_BITS = 8;
+    constexpr size_t DIGIT_COUNT = size_t(1) << DIGIT_BITS;
+
+    const size_t count = codes.size();
+    const size_t chunkCount = (count + ACTORS_PER_CHUNK - 1) / ACTORS_PER_CHUNK;
+    codesBuffer.resize(count);
+    orderBuffer.resize(count);
+    histograms.resize(chunkCount * DIGIT_COUNT);
+
+    for (size_t shift = 0; shift < 3 * MORTON_BITS; shift += DIGIT_BITS) {
+        forEachChunk(count, [&](size_t begin, size_t end) {
+            uint32_t* histogram = &histograms[begin / ACTORS_PER_CHUNK * DIGIT_COUNT];
+            std::fill(histogram, histogram + DIGIT_COUNT, 0);
+            for (size_t i = begin; i < end; ++i) {
+                ++histogram[(codes[i] >> shift) & (DIGIT_COUNT - 1)];
+            }
+        });
+
+        // Turn the counts into where each chunk puts its first key of each digit, digit by digit then chunk by chunk
+        // so the sort is stable. If every key has the same digit the keys are already in order for this pass.
+        bool allSame = false;
+        uint32_t offset = 0;
+        for (size_t digit = 0; digit < DIGIT_COUNT && !allSame; ++digit) {
+            uint32_t digitStart = offset;
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                uint32_t digitCount = histograms[chunk * DIGIT_COUNT + digit];
+                histograms[chunk * DIGIT_COUNT + digit] = offset;
+                offset += digitCount;
+            }
+            allSame = offset - digitStart == count;
+        }
+        if (allSame) continue;
+
+        forEachChunk(count, [&](size_t begin, size_t end) {
+            uint32_t* offsets = &histograms[begin / ACTORS_PER_CHUNK * DIGIT_COUNT];
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t destination = offsets[(codes[i] >> shift) & (DIGIT_COUNT - 1)]++;
+                codesBuffer[destination] = codes[i];
+                orderBuffer[destination] = order[i];
+            }
+        });
+        codes.swap(codesBuffer);
+        order.swap(orderBuffer);
+    }
+}
+
+void LinearOctree::buildNodes() {
+    nodes.clear();
+    if (codes.empty()) return;
+
+    nodes.push_back({BoundingBox(), 0, static_cast<uint32_t>(codes.size()), 0, 0, 0});
+
+    // Nodes are split in the order they were added, so each node's children are added together
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        const uint32_t first = nodes[node].first;
+        const uint32_t end = first + nodes[node].count;
+        if (nodes[node].count <= MAX_ENTITIES) continue;
+
+        // Skip the levels where every actor is in the same octant, the codes are sorted so only the ends need checking
+        uint32_t level = nodes[node].level;
+        while (level < MORTON_BITS && codes[first] >> 3 * (MORTON_BITS - 1 - level) == codes[end - 1] >> 3 * (MORTON_BITS - 1 - level)) {
+            ++level;
+        }
+        nodes[node].level = level;
+
+        // Actors with the same code can't be split any further
+        if (level == MORTON_BITS) continue;
+
+        const uint32_t shift = 3 * (MORTON_BITS - 1 - level);
+        const uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+        for (uint32_t start = first; start < end;) {
+            uint32_t lastCodeInOctant = codes[start] | ((uint32_t(1) << shift) - 1);
+            uint32_t octantEnd = static_cast<uint32_t>(std::upper_bound(codes.begin() + start, codes.begin() + end, lastCodeInOctant) - codes.begin());
+            nodes.push_back({BoundingBox(), start, octantEnd - start, 0, 0, level + 1});
+            start = octantEnd;
+        }
+        nodes[node].firstChild = firstChild;
+        nodes[node].childCount = static_cast<uint32_t>(nodes.size()) - firstChild;
+    }
+
+    // Children always come after their parents, so fitting the nodes backwards fits the children first
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.childCount == 0) {
+            node.bounds = sortedBounds[node.first];
+            for (uint32_t actor = node.first + 1; actor < node.first + node.count; ++actor) {
+                node.bounds = combine(node.bounds, sortedBounds[actor]);
+            }
+        } else {
+            node.bounds = nodes[node.firstChild].bounds;
+            for (uint32_t child = node.firstChild + 1; child < node.firstChild + node.childCount; ++child) {
+                node.bounds = combine(node.bounds, nodes[child].bounds);
+            }
+        }
+    }
+}
+
+void LinearOctree::rebuild() {
+    if (!dirty) return;
+    dirty = false;
+
+    const size_t count = actors.size();
+    const size_t chunkCount = (count + ACTORS_PER_CHUNK - 1) / ACTORS_PER_CHUNK;
+    bounds.resize(count);
+    centres.resize(count);
+    chunkBounds.resize(chunkCount);
+
+    forEachChunk(count, [&](size_t begin, size_t end) {
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        for (size_t i = begin; i < end; ++i) {
+            const BoundingBox& bb = actors[i]->getWorldBoundingBox();
+            bounds[i] = bb;
+            centres[i] = (bb.min + bb.max) * .5f;
+            min = glm::min(min, centres[i]);
+            max = glm::max(max, centres[i]);
+        }
+        chunkBounds[begin / ACTORS_PER_CHUNK] = {min, max};
+    });
+
+    // The codes are spread over a cube around all the centres, so each octant is a cube too
+    BoundingBox centreBounds = chunkBounds.empty() ? BoundingBox(glm::vec3(0), glm::vec3(0)) : chunkBounds[0];
+    for (const BoundingBox& bb: chunkBounds) {
+        centreBounds = combine(centreBounds, bb);
+    }
+    glm::vec3 size = centreBounds.max - centreBounds.min;
+    float largestSide = std::max(size.x, std::max(size.y, size.z));
+    float scale = largestSide > 0 ? static_cast<float>((1u << MORTON_BITS) - 1) / largestSide : 0;
+
+    codes.resize(count);
+    order.resize(count);
+    forEachChunk(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            glm::vec3 cell = (centres[i] - centreBounds.min) * scale;
+            codes[i] = spreadBits(static_cast<uint32_t>(cell.x))
+                       | spreadBits(static_cast<uint32_t>(cell.y)) << 1
+                       | spreadBits(static_cast<uint32_t>(cell.z)) << 2;
+            order[i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    sortCodes();
+
+    sortedActors.resize(count);
+    sortedBounds.resize(count);
+    forEachChunk(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            sortedActors[i] = actors[order[i]];
+            sortedBounds[i] = bounds[order[i]];
+        }
+    });
+
+    buildNodes();
+}
+
+template<typename Function>
+size_t LinearOctree::query(const BoundingBox& bb, uint32_t first, Function&& function) const {
+    if (nodes.empty()) return 0;
+
+    size_t tested = 0;
+    uint32_t stack[QUERY_STACK_SIZE];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (node.first + node.count <= first || !node.bounds.overlaps(bb)) continue;
+
+        if (node.childCount == 0) {
+            for (uint32_t actor = std::max(node.first, first); actor < node.first + node.count; ++actor) {
+                ++tested;
+                if (sortedBounds[actor].overlaps(bb)) function(actor);
+            }
+        } else {
+            for (uint32_t child = node.firstChild; child < node.firstChild + node.childCount; ++child) {
+                stack[stackSize++] = child;
+            }
+        }
+    }
+    return tested;
+}
+
+void LinearOctree::getCloseActors(Actor* actor, std::vector<Actor*>& outVector) {
+    rebuild();
+
+    query(actor->getWorldBoundingBox(), 0, [&](uint32_t other) {
+        if (sortedActors[other] != actor) outVector.push_back(sortedActors[other]);
+    });
+}
+
+size_t LinearOctree::getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    rebuild();
+
+    readFilters(sortedActors, sortedFilters);
+
+    return findPairsInChunks(sortedActors.size(), [&](size_t begin, size_t end, std::vector<std::pair<Actor*, Actor*>>& pairs) {
+        size_t candidates = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (sortedFilters[i].layers == 0) continue;
+
+            // Only the actors after this one are tested, so each pair is found once
+            candidates += query(sortedBounds[i], static_cast<uint32_t>(i + 1), [&](uint32_t other) {
+                if (sortedFilters[i].canCollideWith(sortedFilters[other])) pairs.emplace_back(sortedActors[i], sortedActors[other]);
+            });
+        }
+        return candidates;
+    }, outPairs);
+}
+
+void LinearOctree::clear() {
+    RebuiltBroadPhase::clear();
+    bounds.clear();
+    centres.clear();
+    chunkBounds.clear();
+    codes.clear();
+    order.clear();
+    sortedActors.clear();
+    sortedBounds.clear();
+    sortedFilters.clear();
+    nodes.clear();
+}
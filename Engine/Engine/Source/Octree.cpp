@@ -2,69 +2,181 @@
 // Created by jacob on 01/12/22.
 //
 
+#include <limits>
 #include "Engine/Octree.h"
 
-int Octree::getBoundingBoxOctant(glm::vec3 bbPosition, const BoundingBox& bb) {
-    glm::vec3 position = bbPosition - this->position;
+struct Octree::OctantBlock {
+    Octree octants[8];
+    /** The next block in the pool's free list */
+    OctantBlock* nextFree = nullptr;
+};
 
+struct Octree::Pool {
+    /** The buffers getPotentialPairs uses at one depth of the tree */
+    struct DepthBuffers {
+        std::vector<Actor*> colliders;
+        BoundingBoxList colliderBounds;
+        std::vector<CollisionFilter> colliderFilters;
+        std::vector<Actor*> octantActors;
+        BoundingBoxList octantBounds;
+        std::vector<CollisionFilter> octantFilters;
+        std::vector<uint32_t> overlapping;
+        /** The actors being spilled into the octants of an octree at this depth */
+        std::vector<Actor*> spilled;
+    };
+
+    /** Every block allocated for the tree, in use or not */
+    std::vector<std::unique_ptr<OctantBlock>> blocks;
+    OctantBlock* freeBlocks = nullptr;
+    std::vector<DepthBuffers> depthBuffers;
+    size_t allocations = 0;
+
+    /**
+     * Take a block of octants from the free list, allocating a new one if it is empty
+     * @return The block
+     */
+    OctantBlock* take() {
+        if (freeBlocks == nullptr) {
+            ++allocations;
+            blocks.push_back(std::make_unique<OctantBlock>());
+            return blocks.back().get();
+        }
+
+        OctantBlock* block = freeBlocks;
+        freeBlocks = block->nextFree;
+        return block;
+    }
+
+    /**
+     * Put a block of octants back on the free list
+     * @param block The block
+     */
+    void give(OctantBlock* block) {
+        block->nextFree = freeBlocks;
+        freeBlocks = block;
+    }
+
+    /**
+     * Add a value to a vector, counting an allocation if it has to grow
+     */
+    template<typename Value>
+    void push(std::vector<Value>& vector, const Value& value) {
+        if (vector.size() == vector.capacity()) ++allocations;
+        vector.push_back(value);
+    }
+
+    /**
+     * Add a bounding box to a list, counting an allocation if it has to grow
+     */
+    void push(BoundingBoxList& list, const BoundingBox& bb) {
+        if (list.minX.size() == list.minX.capacity()) ++allocations;
+        list.push_back(bb);
+    }
+
+    /**
+     * Make sure a vector can hold the given number of values without growing, counting an allocation if it has to
+     */
+    template<typename Value>
+    void reserve(std::vector<Value>& vector, size_t size) {
+        if (size <= vector.capacity()) return;
+        ++allocations;
+        vector.reserve(std::max(size, vector.capacity() * 2));
+    }
+};
+
+Octree::Octree(glm::vec3 dimensions, glm::vec3 position, int depth)
+        : dimensions(dimensions), position(position), depth(depth), ownedPool(std::make_unique<Pool>()),
+          regionMin(-std::numeric_limits<float>::infinity()), regionMax(std::numeric_limits<float>::infinity()) {
+    pool = ownedPool.get();
+    pool->depthBuffers.resize(std::max(depth, MAX_DEPTH) + 1);
+}
+
+Octree::Octree() : depth(0), position(0), dimensions(0), pool(nullptr), regionMin(0), regionMax(0) {}
+
+void Octree::placeOctant(glm::vec3 dimensions, glm::vec3 position, Octree* parent, glm::vec3 regionMin, glm::vec3 regionMax) {
+    this->dimensions = dimensions;
+    this->position = position;
+    this->depth = parent->depth + 1;
+    this->parent = parent;
+    this->pool = parent->pool;
+    this->regionMin = regionMin;
+    this->regionMax = regionMax;
+    entities.clear();
+    block = nullptr;
+    actorCount = 0;
+
+    // Octants that have been used before keep their capacity, so this only allocates for new blocks
+    pool->reserve(entities, MAX_ENTITIES);
+}
+
+Octree::~Octree() {
+    for (Actor* actor : this->entities) {
+        actor->octreeNode = nullptr;
+    }
+}
+
+int Octree::getBoundingBoxOctant(const BoundingBox& bb) {
     int index = 0;
-    if ((position.x + bb.min.x) <= 0) {
-        if (position.x + bb.max.x >= 0) return -1;
+    if (bb.min.x <= position.x) {
+        if (bb.max.x >= position.x) return -1;
         index += 1;
     }
 
-    if ((position.y + bb.min.y) <= 0) {
-        if (position.y + bb.max.y >= 0) return -1;
+    if (bb.min.y <= position.y) {
+        if (bb.max.y >= position.y) return -1;
         index += 2;
     }
 
-    if ((position.z + bb.min.z) <= 0) {
-        if (position.z + bb.max.z >= 0) return -1;
+    if (bb.min.z <= position.z) {
+        if (bb.max.z >= position.z) return -1;
         index += 4;
     }
 
     return index;
 }
 
-void Octree::getAllOverlappedOctants(glm::vec3 bbPosition, const BoundingBox& bb, std::vector<Octree*>& outOctants) {
-    glm::vec3 position = bbPosition - this->position;
+uint8_t Octree::getOverlappedOctants(const BoundingBox& bb) const {
+    uint8_t octants = 0;
+    glm::vec3 min = bb.min - this->position;
+    glm::vec3 max = bb.max - this->position;
 
-    if ((position.x + bb.max.x) >= 0) {
-        if ((position.y + bb.max.y) >= 0) {
-            if ((position.z + bb.max.z) >= 0) {
-                outOctants.push_back(subTrees[BOTTOMFRONTRIGHTINDEX]);
+    if (max.x >= 0) {
+        if (max.y >= 0) {
+            if (max.z >= 0) {
+                octants |= 1 << BOTTOMFRONTRIGHTINDEX;
             }
-            if (position.z + bb.min.z < 0) {
-                outOctants.push_back(subTrees[BOTTOMBACKRIGHTINDEX]);
+            if (min.z < 0) {
+                octants |= 1 << BOTTOMBACKRIGHTINDEX;
             }
         }
-        if (position.y + bb.min.y < 0) {
-            if ((position.z + bb.max.z) >= 0) {
-                outOctants.push_back(subTrees[TOPFRONTRIGHTINDEX]);
+        if (min.y < 0) {
+            if (max.z >= 0) {
+                octants |= 1 << TOPFRONTRIGHTINDEX;
             }
-            if (position.z + bb.min.z < 0) {
-                outOctants.push_back(subTrees[TOPBACKRIGHTINDEX]);
+            if (min.z < 0) {
+                octants |= 1 << TOPBACKRIGHTINDEX;
             }
         }
     }
-    if (position.x + bb.min.x < 0) {
-        if ((position.y + bb.max.y) >= 0) {
-            if ((position.z + bb.max.z) >= 0) {
-                outOctants.push_back(subTrees[BOTTOMFRONTLEFINDEX]);
+    if (min.x < 0) {
+        if (max.y >= 0) {
+            if (max.z >= 0) {
+                octants |= 1 << BOTTOMFRONTLEFINDEX;
             }
-            if (position.z + bb.min.z < 0) {
-                outOctants.push_back(subTrees[BOTTOMBACKLEFTINDEX]);
+            if (min.z < 0) {
+                octants |= 1 << BOTTOMBACKLEFTINDEX;
             }
         }
-        if (position.y + bb.min.y < 0) {
-            if ((position.z + bb.max.z) >= 0) {
-                outOctants.push_back(subTrees[TOPFRONTLEFINDEX]);
+        if (min.y < 0) {
+            if (max.z >= 0) {
+                octants |= 1 << TOPFRONTLEFINDEX;
             }
-            if (position.z + bb.min.z < 0) {
-                outOctants.push_back(subTrees[TOPBACKLEFTINDEX]);
+            if (min.z < 0) {
+                octants |= 1 << TOPBACKLEFTINDEX;
             }
         }
     }
+    return octants;
 }
 
 int Octree::getPointOctant(glm::vec3 point) {
@@ -86,50 +198,197 @@ int Octree::getPointOctant(glm::vec3 point) {
     return index;
 }
 
+bool Octree::isInRegion(const BoundingBox& bb) const {
+    return bb.min.x > regionMin.x && bb.min.y > regionMin.y && bb.min.z > regionMin.z
+        && bb.max.x < regionMax.x && bb.max.y < regionMax.y && bb.max.z < regionMax.z;
+}
+
+bool Octree::overlapsRegion(const BoundingBox& bb) const {
+    return bb.max.x >= regionMin.x && bb.max.y >= regionMin.y && bb.max.z >= regionMin.z
+        && bb.min.x < regionMax.x && bb.min.y < regionMax.y && bb.min.z < regionMax.z;
+}
+
 void Octree::spill() {
     glm::vec3 newDimensions = dimensions * .5f;
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3( newDimensions.x, -newDimensions.y,  newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3(-newDimensions.x, -newDimensions.y,  newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3( newDimensions.x,  newDimensions.y,  newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3(-newDimensions.x,  newDimensions.y,  newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3( newDimensions.x, -newDimensions.y, -newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3(-newDimensions.x, -newDimensions.y, -newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3( newDimensions.x,  newDimensions.y, -newDimensions.z), depth + 1));
-    subTrees.push_back(new Octree(newDimensions, position + glm::vec3(-newDimensions.x,  newDimensions.y, -newDimensions.z), depth + 1));
-
-    std::vector<Actor*> temp(this->entities);
+    block = pool->take();
+
+    // Octant indices are built from the sides of the centre the octant is on, see getBoundingBoxOctant
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 sign(i & 1 ? -1 : 1, i & 2 ? -1 : 1, i & 4 ? -1 : 1);
+        glm::vec3 octantMin(sign.x < 0 ? regionMin.x : position.x, sign.y < 0 ? regionMin.y : position.y, sign.z < 0 ? regionMin.z : position.z);
+        glm::vec3 octantMax(sign.x < 0 ? position.x : regionMax.x, sign.y < 0 ? position.y : regionMax.y, sign.z < 0 ? position.z : regionMax.z);
+
+        block->octants[i].placeOctant(newDimensions, position + newDimensions * sign, this, octantMin, octantMax);
+    }
+
+    // Spilling only inserts into the octants, which are deeper, so each depth can keep its own buffer
+    std::vector<Actor*>& temp = pool->depthBuffers[depth].spilled;
+    temp.clear();
+    for (Actor* actor : entities) {
+        pool->push(temp, actor);
+    }
     entities.clear();
+    actorCount -= temp.size();
     for (Actor* actor : temp) {
         insertNode(actor);
     }
 }
 
+void Octree::insertActor(Actor* actor) {
+    insertNode(actor);
+}
+
 void Octree::insertNode(Actor* actor) {
-    if (subTrees.empty()) {
-        entities.push_back(actor);
-        if (entities.size() == 8 && this->depth != this->MAX_DEPTH) spill();
+    ++actorCount;
+    if (block == nullptr) {
+        actor->octreeNode = this;
+        actor->octreeIndex = entities.size();
+        pool->push(entities, actor);
+        if (entities.size() >= MAX_ENTITIES && this->depth < MAX_DEPTH) spill();
     } else {
-        int quadrantIndex = getBoundingBoxOctant(actor->getPosition(), actor->getBoundingBox());
+        int quadrantIndex = getBoundingBoxOctant(actor->getWorldBoundingBox());
         if (quadrantIndex < 0) {
-            entities.push_back(actor);
+            actor->octreeNode = this;
+            actor->octreeIndex = entities.size();
+            pool->push(entities, actor);
         } else {
-            subTrees[quadrantIndex]->insertNode(actor);
+            block->octants[quadrantIndex].insertNode(actor);
         }
     }
 }
 
+bool Octree::updateActor(Actor* actor) {
+    Octree* node = actor->octreeNode;
+    if (node == nullptr) {
+        insertNode(actor);
+        return true;
+    }
+
+    BoundingBox bb = actor->getWorldBoundingBox();
+
+    // Still in the right place if it's within the region, and can't be pushed any further down the tree
+    bool inRegion = node->isInRegion(bb);
+    if (inRegion && (node->block == nullptr || node->getBoundingBoxOctant(bb) < 0)) return false;
+
+    // Find the closest octree that contains the actor
+    Octree* target = node;
+    while (!target->isInRegion(bb) && target->parent != nullptr && target != this) {
+        target = target->parent;
+    }
+
+    detachActor(actor);
+
+    // insertNode only counts the actor from the target downwards
+    for (Octree* ancestor = target->parent; ancestor != nullptr; ancestor = ancestor->parent) {
+        ++ancestor->actorCount;
+    }
+    target->insertNode(actor);
+
+    node->mergeEmptyOctants();
+    return true;
+}
+
 void Octree::getCloseActors(Actor* actor, std::vector<Actor*>& outVector) {
-    for (const auto& item: entities) {
-        outVector.push_back(item);
+    const BoundingBox& bb = actor->getWorldBoundingBox();
+
+    // Walk the tree with a fixed size stack rather than recursing, so a query never allocates
+    Octree* stack[QUERY_STACK_SIZE];
+    size_t stackSize = 0;
+    stack[stackSize++] = this;
+    while (stackSize > 0) {
+        Octree* node = stack[--stackSize];
+        for (Actor* item: node->entities) {
+            if (item != actor && item->getWorldBoundingBox().overlaps(bb)) outVector.push_back(item);
+        }
+        if (node->block == nullptr) continue;
+
+        uint8_t octants = node->getOverlappedOctants(bb);
+        for (int i = 0; i < 8; ++i) {
+            Octree& octant = node->block->octants[i];
+            if (octants & (1 << i) && octant.actorCount != 0) stack[stackSize++] = &octant;
+        }
+    }
+}
+
+size_t Octree::getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    return getPotentialPairs({}, {}, {}, outPairs);
+}
+
+size_t Octree::getPotentialPairs(const std::vector<Actor*>& ancestorActors, const BoundingBoxList& ancestorBounds,
+                                 const std::vector<CollisionFilter>& ancestorFilters,
+                                 std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    size_t candidates = 0;
+
+    // The tree is at most MAX_DEPTH deep, so each depth can reuse its own buffers without clobbering its callers'
+    Pool::DepthBuffers& buffers = pool->depthBuffers[depth];
+    std::vector<Actor*>& colliders = buffers.colliders;
+    BoundingBoxList& colliderBounds = buffers.colliderBounds;
+    std::vector<CollisionFilter>& colliderFilters = buffers.colliderFilters;
+    colliders.clear();
+    colliderBounds.clear();
+    colliderFilters.clear();
+    for (Actor* actor: entities) {
+        CollisionFilter filter = actor->getCollisionFilter();
+        if (filter.layers == 0) continue;
+        pool->push(colliders, actor);
+        pool->push(colliderBounds, actor->getWorldBoundingBox());
+        pool->push(colliderFilters, filter);
+    }
+
+    // Every actor is only stored once, so pairing each actor with the ones after it and the ones further up the tree
+    // gives every pair exactly once
+    std::vector<uint32_t>& overlapping = buffers.overlapping;
+    pool->reserve(overlapping, std::max(ancestorActors.size(), colliders.size()));
+    for (size_t i = 0; i < colliders.size(); ++i) {
+        Actor* actor = colliders[i];
+        const BoundingBox& bb = actor->getWorldBoundingBox();
+
+        overlapping.clear();
+        ancestorBounds.getOverlapping(bb, 0, overlapping);
+        for (uint32_t index: overlapping) {
+            if (ancestorFilters[index].canCollideWith(colliderFilters[i])) outPairs.emplace_back(ancestorActors[index], actor);
+        }
+
+        overlapping.clear();
+        colliderBounds.getOverlapping(bb, i + 1, overlapping);
+        for (uint32_t index: overlapping) {
+            if (colliderFilters[i].canCollideWith(colliderFilters[index])) outPairs.emplace_back(actor, colliders[index]);
+        }
+
+        candidates += ancestorActors.size() + colliders.size() - i - 1;
     }
 
-    if (!subTrees.empty()) {
-        std::vector<Octree*> overlappedOctants;
-        getAllOverlappedOctants(actor->getPosition(), actor->getBoundingBox(), overlappedOctants);
-        for (const auto& octant: overlappedOctants) {
-            octant->getCloseActors(actor, outVector);
+    if (block == nullptr) return candidates;
+
+    // Only pass the actors down to the octants they overlap
+    std::vector<Actor*>& octantActors = buffers.octantActors;
+    BoundingBoxList& octantBounds = buffers.octantBounds;
+    std::vector<CollisionFilter>& octantFilters = buffers.octantFilters;
+    for (Octree& subTree: block->octants) {
+        if (subTree.actorCount == 0) continue;
+
+        octantActors.clear();
+        octantBounds.clear();
+        octantFilters.clear();
+        for (size_t i = 0; i < ancestorActors.size(); ++i) {
+            if (subTree.overlapsRegion(ancestorActors[i]->getWorldBoundingBox())) {
+                pool->push(octantActors, ancestorActors[i]);
+                pool->push(octantBounds, ancestorActors[i]->getWorldBoundingBox());
+                pool->push(octantFilters, ancestorFilters[i]);
+            }
         }
+        for (size_t i = 0; i < colliders.size(); ++i) {
+            if (subTree.overlapsRegion(colliders[i]->getWorldBoundingBox())) {
+                pool->push(octantActors, colliders[i]);
+                pool->push(octantBounds, colliders[i]->getWorldBoundingBox());
+                pool->push(octantFilters, colliderFilters[i]);
+            }
+        }
+
+        candidates += subTree.getPotentialPairs(octantActors, octantBounds, octantFilters, outPairs);
     }
+
+    return candidates;
 }
 
 void Octree::getAllActors(std::vector<Actor*>& outVector) {
@@ -137,42 +396,84 @@ void Octree::getAllActors(std::vector<Actor*>& outVector) {
         outVector.push_back(entity);
     }
 
-    for (const auto& subTree: subTrees) {
-        subTree->getAllActors(outVector);
+    if (block == nullptr) return;
+    for (Octree& subTree: block->octants) {
+        subTree.getAllActors(outVector);
     }
 }
 
-bool Octree::removeActor(Actor* actor) {
-    auto index = std::find(entities.begin(), entities.end(), actor);
-    if (index != entities.end()) {
-        for (const auto& subTree: subTrees) {
-            if (removeActor(actor)) return true;
-        }
-        return false;
+void Octree::detachActor(Actor* actor) {
+    Octree* node = actor->octreeNode;
+
+    // Swap with the back and pop, then fix up the index of the actor that got moved
+    Actor* last = node->entities.back();
+    node->entities[actor->octreeIndex] = last;
+    last->octreeIndex = actor->octreeIndex;
+    node->entities.pop_back();
+
+    for (Octree* ancestor = node; ancestor != nullptr; ancestor = ancestor->parent) {
+        --ancestor->actorCount;
     }
 
-    entities.erase(index);
-    return true;
+    actor->octreeNode = nullptr;
+    actor->octreeIndex = 0;
 }
 
-bool Octree::removeActor(Actor* actor, glm::vec3 positionHint) {
-    auto index = std::find(entities.begin(), entities.end(), actor);
-    if (index != entities.end()) {
-        if (!subTrees.empty()) {
-            return subTrees[getPointOctant(positionHint)]->removeActor(actor, positionHint);
-        }
-        return false;
+void Octree::releaseOctants() {
+    if (block == nullptr) return;
+
+    for (Octree& subTree: block->octants) {
+        subTree.releaseOctants();
+    }
+    pool->give(block);
+    block = nullptr;
+}
+
+void Octree::mergeEmptyOctants() {
+    Octree* toMerge = nullptr;
+    for (Octree* ancestor = this; ancestor != nullptr; ancestor = ancestor->parent) {
+        if (ancestor->block != nullptr && ancestor->actorCount == ancestor->entities.size()) toMerge = ancestor;
     }
+    if (toMerge == nullptr) return;
 
-    entities.erase(index);
+    toMerge->releaseOctants();
+}
+
+bool Octree::removeActor(Actor* actor) {
+    Octree* node = actor->octreeNode;
+    if (node == nullptr) return false;
+
+    // Make sure the actor is actually stored somewhere in this octree
+    Octree* ancestor = node;
+    while (ancestor != this && ancestor != nullptr) {
+        ancestor = ancestor->parent;
+    }
+    if (ancestor == nullptr) return false;
+
+    detachActor(actor);
+    node->mergeEmptyOctants();
     return true;
 }
 
 void Octree::clearTree() {
+    for (Actor* actor : entities) {
+        actor->octreeNode = nullptr;
+    }
     entities.clear();
-    for (auto& subTree: subTrees) {
-        subTree->clearTree();
-        delete subTree;
+    if (block != nullptr) {
+        for (Octree& subTree: block->octants) {
+            subTree.clearTree();
+        }
+        pool->give(block);
+        block = nullptr;
     }
-    subTrees.clear();
+    actorCount = 0;
+}
+
+void Octree::clear() {
+    clearTree();
+}
+
+size_t Octree::getAllocationCount() const {
+    return pool->allocations;
 }
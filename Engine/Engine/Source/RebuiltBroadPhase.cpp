@@ -0,0 +1,95 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/RebuiltBroadPhase.h"
+#include "Scene/Actor/Actor.h"
+#include "Utils/ThreadPool.h"
+
+#include <algorithm>
+
+RebuiltBroadPhase::RebuiltBroadPhase(ThreadPool* threadPool, size_t chunkSize) : threadPool(threadPool), chunkSize(chunkSize) {}
+
+bool RebuiltBroadPhase::contains(const Actor* actor) const {
+    int32_t proxy = actor->broadPhaseProxy;
+    return proxy >= 0 && static_cast<size_t>(proxy) < actors.size() && actors[proxy] == actor;
+}
+
+void RebuiltBroadPhase::forEachChunk(size_t count, const std::function<void(size_t, size_t)>& function) {
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(count, chunkSize, function);
+        return;
+    }
+
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        function(begin, std::min(begin + chunkSize, count));
+    }
+}
+
+void RebuiltBroadPhase::readFilters(const std::vector<Actor*>& sourceActors, std::vector<CollisionFilter>& destFilters) {
+    destFilters.resize(sourceActors.size());
+    forEachChunk(sourceActors.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            destFilters[i] = sourceActors[i]->getCollisionFilter();
+        }
+    });
+}
+
+size_t RebuiltBroadPhase::findPairsInChunks(size_t count, const std::function<size_t(size_t, size_t, std::vector<std::pair<Actor*, Actor*>>&)>& function,
+                                            std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    chunkPairs.resize(std::max(chunkPairs.size(), chunkCount));
+    chunkCandidates.assign(chunkCount, 0);
+
+    forEachChunk(count, [&](size_t begin, size_t end) {
+        size_t chunk = begin / chunkSize;
+        chunkPairs[chunk].clear();
+        chunkCandidates[chunk] = function(begin, end, chunkPairs[chunk]);
+    });
+
+    size_t candidates = 0;
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        outPairs.insert(outPairs.end(), chunkPairs[chunk].begin(), chunkPairs[chunk].end());
+        candidates += chunkCandidates[chunk];
+    }
+    return candidates;
+}
+
+void RebuiltBroadPhase::insertActor(Actor* actor) {
+    if (contains(actor)) return;
+
+    actor->broadPhaseProxy = static_cast<int32_t>(actors.size());
+    actors.push_back(actor);
+    dirty = true;
+}
+
+bool RebuiltBroadPhase::removeActor(Actor* actor) {
+    if (!contains(actor)) return false;
+
+    // Swap the last actor into its place, the index is rebuilt anyway so the order doesn't matter
+    Actor* last = actors.back();
+    actors[actor->broadPhaseProxy] = last;
+    last->broadPhaseProxy = actor->broadPhaseProxy;
+    actors.pop_back();
+    actor->broadPhaseProxy = -1;
+    dirty = true;
+    return true;
+}
+
+bool RebuiltBroadPhase::updateActor(Actor* actor) {
+    insertActor(actor);
+    dirty = true;
+    return false;
+}
+
+void RebuiltBroadPhase::getAllActors(std::vector<Actor*>& outVector) {
+    outVector.insert(outVector.end(), actors.begin(), actors.end());
+}
+
+void RebuiltBroadPhase::clear() {
+    for (Actor* actor: actors) {
+        actor->broadPhaseProxy = -1;
+    }
+    actors.clear();
+    dirty = false;
+}
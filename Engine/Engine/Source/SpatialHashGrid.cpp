@@ -0,0 +1,238 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/SpatialHashGrid.h"
+#include "Scene/Actor/Actor.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    /** Counted in doubles, so huge actors can't overflow */
+    double getCellCount(const glm::ivec3& min, const glm::ivec3& max) {
+        return (static_cast<double>(max.x) - min.x + 1) * (static_cast<double>(max.y) - min.y + 1)
+               * (static_cast<double>(max.z) - min.z + 1);
+    }
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize, ThreadPool* threadPool) : RebuiltBroadPhase(threadPool, CELLS_PER_CHUNK),
+                                                                          cellSize(cellSize), inverseCellSize(1.f / cellSize) {}
+
+glm::ivec3 SpatialHashGrid::getCell(const glm::vec3& point) const {
+    return glm::ivec3(glm::floor(point * inverseCellSize));
+}
+
+uint32_t SpatialHashGrid::findSlot(const glm::ivec3& cell) const {
+    uint32_t hash = static_cast<uint32_t>(cell.x) * 73856093u
+                    ^ static_cast<uint32_t>(cell.y) * 19349663u
+                    ^ static_cast<uint32_t>(cell.z) * 83492791u;
+    const uint32_t mask = static_cast<uint32_t>(cells.size()) - 1;
+
+    // Fibonacci hashing spreads the high bits of the hash over the table, then neighbouring slots are probed in turn
+    uint32_t slot = (hash * 0x9E3779B1u) >> (32 - cellBits);
+    while (cells[slot].count != 0 && (cells[slot].x != cell.x || cells[slot].y != cell.y || cells[slot].z != cell.z)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void SpatialHashGrid::rebuild() {
+    if (!dirty) return;
+    dirty = false;
+
+    const size_t actorCount = actors.size();
+    bounds.resize(actorCount);
+    cellRanges.resize(actorCount);
+
+    forEachChunk(actorCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            bounds[i] = actors[i]->getWorldBoundingBox();
+            cellRanges[i].min = getCell(bounds[i].min);
+            cellRanges[i].max = getCell(bounds[i].max);
+        }
+    });
+
+    // Give each actor its place in the cell entries, leaving out the ones that cover too many cells
+    oversizedActors.clear();
+    size_t entryCount = 0;
+    for (size_t i = 0; i < actorCount; ++i) {
+        CellRange& range = cellRanges[i];
+        double cellCount = getCellCount(range.min, range.max);
+        range.firstEntry = entryCount;
+        if (cellCount > static_cast<double>(MAX_CELLS_PER_ACTOR)) {
+            range.entryCount = 0;
+            oversizedActors.push_back(static_cast<uint32_t>(i));
+        } else {
+            range.entryCount = static_cast<size_t>(cellCount);
+            entryCount += range.entryCount;
+        }
+    }
+
+    // Oversized actors are tested against every actor, which is quicker with the bounds in a list
+    allBounds.clear();
+    if (!oversizedActors.empty()) {
+        for (const BoundingBox& bb: bounds) {
+            allBounds.push_back(bb);
+        }
+    }
+
+    cellEntries.resize(entryCount);
+    forEachChunk(actorCount, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const CellRange& range = cellRanges[i];
+            if (range.entryCount == 0) continue;
+
+            size_t entry = range.firstEntry;
+            for (int z = range.min.z; z <= range.max.z; ++z) {
+                for (int y = range.min.y; y <= range.max.y; ++y) {
+                    for (int x = range.min.x; x <= range.max.x; ++x) {
+                        cellEntries[entry++] = glm::ivec3(x, y, z);
+                    }
+                }
+            }
+        }
+    });
+
+    // Size the table so it is at most half full, which keeps the probes short
+    cellBits = 4;
+    while ((size_t(1) << cellBits) < entryCount * 2) ++cellBits;
+    cells.assign(size_t(1) << cellBits, Cell{0, 0, 0, 0, 0});
+    usedSlots.clear();
+
+    // Counting sort the actors into the cells, first counting the actors in each cell
+    entrySlots.resize(entryCount);
+    for (size_t entry = 0; entry < entryCount; ++entry) {
+        const glm::ivec3& coordinates = cellEntries[entry];
+        uint32_t slot = findSlot(coordinates);
+        Cell& cell = cells[slot];
+        if (cell.count == 0) {
+            cell.x = coordinates.x;
+            cell.y = coordinates.y;
+            cell.z = coordinates.z;
+            usedSlots.push_back(slot);
+        }
+        ++cell.count;
+        entrySlots[entry] = slot;
+    }
+
+    uint32_t start = 0;
+    for (uint32_t slot: usedSlots) {
+        cells[slot].start = start;
+        start += cells[slot].count;
+        cells[slot].count = 0;
+    }
+
+    // Then putting each actor after the ones already in its cells, which counts them back up again
+    cellActors.resize(entryCount);
+    cellBounds.resize(entryCount);
+    for (size_t i = 0; i < actorCount; ++i) {
+        const CellRange& range = cellRanges[i];
+        for (size_t entry = range.firstEntry; entry < range.firstEntry + range.entryCount; ++entry) {
+            Cell& cell = cells[entrySlots[entry]];
+            cellActors[cell.start + cell.count] = static_cast<uint32_t>(i);
+            cellBounds[cell.start + cell.count] = bounds[i];
+            ++cell.count;
+        }
+    }
+}
+
+void SpatialHashGrid::getCloseActors(Actor* actor, std::vector<Actor*>& outVector) {
+    rebuild();
+
+    const BoundingBox& bb = actor->getWorldBoundingBox();
+    glm::ivec3 minCell = getCell(bb.min);
+    glm::ivec3 maxCell = getCell(bb.max);
+
+    // Looking up every cell of a large actor would take longer than testing every actor
+    if (cells.empty() || getCellCount(minCell, maxCell) > static_cast<double>(MAX_CELLS_PER_ACTOR)) {
+        for (size_t i = 0; i < actors.size(); ++i) {
+            if (actors[i] != actor && bounds[i].overlaps(bb)) outVector.push_back(actors[i]);
+        }
+        return;
+    }
+
+    for (int z = minCell.z; z <= maxCell.z; ++z) {
+        for (int y = minCell.y; y <= maxCell.y; ++y) {
+            for (int x = minCell.x; x <= maxCell.x; ++x) {
+                glm::ivec3 coordinates(x, y, z);
+                const Cell& cell = cells[findSlot(coordinates)];
+
+                for (uint32_t i = cell.start; i < cell.start + cell.count; ++i) {
+                    uint32_t other = cellActors[i];
+                    if (actors[other] == actor || !cellBounds[i].overlaps(bb)) continue;
+
+                    // Actors that share several cells are only found in the cell the corner of their overlap is in
+                    if (getCell(glm::max(bb.min, cellBounds[i].min)) != coordinates) continue;
+                    outVector.push_back(actors[other]);
+                }
+            }
+        }
+    }
+
+    for (uint32_t other: oversizedActors) {
+        if (actors[other] != actor && bounds[other].overlaps(bb)) outVector.push_back(actors[other]);
+    }
+}
+
+size_t SpatialHashGrid::getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    rebuild();
+
+    readFilters(actors, filters);
+
+    size_t candidates = findPairsInChunks(usedSlots.size(), [&](size_t begin, size_t end, std::vector<std::pair<Actor*, Actor*>>& pairs) {
+        size_t chunkCandidates = 0;
+        for (size_t slot = begin; slot < end; ++slot) {
+            const Cell& cell = cells[usedSlots[slot]];
+            chunkCandidates += cell.count * (cell.count - 1) / 2;
+            const glm::ivec3 coordinates(cell.x, cell.y, cell.z);
+            const uint32_t* cellStart = &cellActors[cell.start];
+            const BoundingBox* cellStartBounds = &cellBounds[cell.start];
+
+            for (uint32_t a = 0; a + 1 < cell.count; ++a) {
+                for (uint32_t b = a + 1; b < cell.count; ++b) {
+                    if (!cellStartBounds[a].overlaps(cellStartBounds[b])) continue;
+
+                    uint32_t i = cellStart[a];
+                    uint32_t j = cellStart[b];
+                    if (!filters[i].canCollideWith(filters[j])) continue;
+
+                    // Actors that share several cells are only paired in the cell the corner of their overlap is in
+                    if (getCell(glm::max(cellStartBounds[a].min, cellStartBounds[b].min)) != coordinates) continue;
+                    pairs.emplace_back(actors[i], actors[j]);
+                }
+            }
+        }
+        return chunkCandidates;
+    }, outPairs);
+
+    // Oversized actors aren't in any cells, so they are tested against everything, and each other only once
+    for (uint32_t i: oversizedActors) {
+        if (filters[i].layers == 0) continue;
+
+        overlapping.clear();
+        candidates += actors.size() - 1;
+        allBounds.getOverlapping(bounds[i], 0, overlapping);
+        for (uint32_t j: overlapping) {
+            if (j == i || !filters[i].canCollideWith(filters[j]) || (cellRanges[j].entryCount == 0 && j < i)) continue;
+            outPairs.emplace_back(actors[i], actors[j]);
+        }
+    }
+    return candidates;
+}
+
+void SpatialHashGrid::clear() {
+    RebuiltBroadPhase::clear();
+    bounds.clear();
+    filters.clear();
+    cellRanges.clear();
+    oversizedActors.clear();
+    allBounds.clear();
+    cellEntries.clear();
+    entrySlots.clear();
+    cells.clear();
+    usedSlots.clear();
+    cellActors.clear();
+    cellBounds.clear();
+}
@@ -0,0 +1,107 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/StaticAABBTree.h"
+
+#include <Utils/Logger.h>
+
+#include <fstream>
+#include <filesystem>
+#define STATICTREEVERSION 1
+
+void StaticAABBTree::build(const std::vector<Actor*>& staticActors) {
+    clear();
+
+    std::vector<BoundingBox> bounds;
+    bounds.reserve(staticActors.size());
+    for (Actor* actor: staticActors) {
+        bounds.push_back(actor->getWorldBoundingBox());
+    }
+    hierarchy.build(bounds, actorIndices);
+
+    actors.reserve(actorIndices.size());
+    for (uint32_t index: actorIndices) {
+        actors.push_back(staticActors[index]);
+    }
+}
+
+bool StaticAABBTree::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        Logger::warn("Failed to save static collision tree at " + filePath);
+        return false;
+    }
+
+    uint8_t version = STATICTREEVERSION;
+    uint32_t nodeCount = hierarchy.getNodeCount();
+    auto actorCount = static_cast<uint32_t>(actorIndices.size());
+    file.write(reinterpret_cast<const char*>(&version), 1);
+    file.write(reinterpret_cast<const char*>(&nodeCount), 4);
+    file.write(reinterpret_cast<const char*>(&actorCount), 4);
+    hierarchy.write(file);
+    file.write(reinterpret_cast<const char*>(actorIndices.data()), actorCount * sizeof(uint32_t));
+
+    file.close();
+    return true;
+}
+
+bool StaticAABBTree::loadFromFile(const std::string& filePath, const std::vector<Actor*>& staticActors) {
+    clear();
+    if (!std::filesystem::exists(filePath)) {
+        Logger::warn("Failed to load static collision tree at " + filePath);
+        return false;
+    }
+    std::ifstream file(filePath, std::ios::binary);
+    uint8_t version;
+    uint32_t nodeCount, actorCount;
+    file.read(reinterpret_cast<char*>(&version), 1);
+    if (version != STATICTREEVERSION) {
+        Logger::warn("Incorrect version of static collision tree standard, this file cannot be read");
+        file.close();
+        return false;
+    }
+
+    file.read(reinterpret_cast<char*>(&nodeCount), 4);
+    file.read(reinterpret_cast<char*>(&actorCount), 4);
+    if (actorCount != staticActors.size()) {
+        Logger::warn("Static collision tree at " + filePath + " was baked for a different set of actors");
+        file.close();
+        return false;
+    }
+    bool valid = hierarchy.read(file, nodeCount, actorCount);
+    actorIndices.resize(valid ? actorCount : 0);
+    file.read(reinterpret_cast<char*>(actorIndices.data()), actorIndices.size() * sizeof(uint32_t));
+    valid = valid && file;
+    file.close();
+
+    // Each actor must be in exactly one leaf
+    std::vector<bool> seen(actorIndices.size(), false);
+    for (size_t i = 0; valid && i < actorIndices.size(); ++i) {
+        valid = actorIndices[i] < actorCount && !seen[actorIndices[i]];
+        if (valid) seen[actorIndices[i]] = true;
+    }
+    if (!valid) {
+        Logger::warn("Static collision tree at " + filePath + " is corrupt");
+        clear();
+        return false;
+    }
+
+    actors.reserve(actorCount);
+    std::vector<BoundingBox> bounds;
+    bounds.reserve(actorCount);
+    for (uint32_t index: actorIndices) {
+        actors.push_back(staticActors[index]);
+        bounds.push_back(staticActors[index]->getWorldBoundingBox());
+    }
+
+    // The actors may have been moved since the tree was baked, so the saved bounds can't be trusted to contain them
+    hierarchy.refit(bounds);
+    return true;
+}
+
+void StaticAABBTree::clear() {
+    hierarchy.clear();
+    actors.clear();
+    actorIndices.clear();
+}
@@ -0,0 +1,170 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Engine/SweepAndPrune.h"
+#include "Scene/Actor/Actor.h"
+
+#include <algorithm>
+
+SweepAndPrune::SweepAndPrune(int axis) : axis(axis < 0 ? 0 : axis), chooseAxis(axis < 0) {}
+
+int SweepAndPrune::getWidestAxis() const {
+    glm::vec3 sum(0), sumSquared(0);
+    for (const Entry& entry: entries) {
+        glm::vec3 centre = (entry.bounds.min + entry.bounds.max) * .5f;
+        sum += centre;
+        sumSquared += centre * centre;
+    }
+    glm::vec3 mean = sum / static_cast<float>(entries.size());
+    glm::vec3 variance = sumSquared / static_cast<float>(entries.size()) - mean * mean;
+
+    int widest = axis;
+    for (int i = 0; i < 3; ++i) {
+        if (variance[i] > variance[widest] * AXIS_SWITCH_RATIO) widest = i;
+    }
+    return widest;
+}
+
+void SweepAndPrune::refresh() {
+    if (!dirty) return;
+    dirty = false;
+
+    maxExtent = 0;
+    for (Entry& entry: entries) {
+        entry.bounds = entry.actor->getWorldBoundingBox();
+    }
+
+    int newAxis = chooseAxis && !entries.empty() ? getWidestAxis() : axis;
+    for (const Entry& entry: entries) {
+        maxExtent = std::max(maxExtent, entry.bounds.max[newAxis] - entry.bounds.min[newAxis]);
+    }
+
+    sortEntries(newAxis);
+
+    sortedBounds.clear();
+    for (const Entry& entry: entries) {
+        sortedBounds.push_back(entry.bounds);
+    }
+}
+
+void SweepAndPrune::sortEntries(int newAxis) {
+    auto compare = [&](const Entry& a, const Entry& b) {
+        return a.bounds.min[axis] < b.bounds.min[axis];
+    };
+
+    // A new axis means a completely different order, otherwise the actors have barely moved so are nearly sorted
+    if (newAxis != axis) {
+        axis = newAxis;
+        std::sort(entries.begin(), entries.end(), compare);
+        sortedCount = entries.size();
+        return;
+    }
+
+    for (size_t i = 1; i < sortedCount; ++i) {
+        float key = entries[i].bounds.min[axis];
+        if (entries[i - 1].bounds.min[axis] <= key) continue;
+
+        Entry entry = entries[i];
+        size_t j = i;
+        while (j > 0 && entries[j - 1].bounds.min[axis] > key) {
+            entries[j] = entries[j - 1];
+            --j;
+        }
+        entries[j] = entry;
+    }
+
+    // New actors could be anywhere, so they are sorted on their own then merged in
+    if (sortedCount < entries.size()) {
+        auto firstNew = entries.begin() + static_cast<std::ptrdiff_t>(sortedCount);
+        std::sort(firstNew, entries.end(), compare);
+        std::inplace_merge(entries.begin(), firstNew, entries.end(), compare);
+        sortedCount = entries.size();
+    }
+}
+
+void SweepAndPrune::insertActor(Actor* actor) {
+    if (!actors.insert(actor).second) return;
+
+    entries.push_back({actor->getWorldBoundingBox(), actor, actor->getCollisionFilter()});
+    dirty = true;
+}
+
+bool SweepAndPrune::removeActor(Actor* actor) {
+    if (actors.erase(actor) == 0) return false;
+
+    // Erasing keeps the rest of the entries in order
+    auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return entry.actor == actor;
+    });
+    if (static_cast<size_t>(entry - entries.begin()) < sortedCount) --sortedCount;
+    entries.erase(entry);
+
+    // The bounds list and the longest extent still include the actor, so they need refreshing before the next sweep
+    dirty = true;
+    return true;
+}
+
+bool SweepAndPrune::updateActor(Actor* actor) {
+    insertActor(actor);
+    dirty = true;
+    return false;
+}
+
+void SweepAndPrune::getCloseActors(Actor* actor, std::vector<Actor*>& outVector) {
+    refresh();
+
+    const BoundingBox& bb = actor->getWorldBoundingBox();
+
+    // Nothing starting further back than the longest actor can reach this one
+    auto first = std::lower_bound(entries.begin(), entries.end(), bb.min[axis] - maxExtent, [&](const Entry& entry, float value) {
+        return entry.bounds.min[axis] < value;
+    });
+    for (auto entry = first; entry != entries.end() && entry->bounds.min[axis] <= bb.max[axis]; ++entry) {
+        if (entry->actor != actor && entry->bounds.overlaps(bb)) outVector.push_back(entry->actor);
+    }
+}
+
+size_t SweepAndPrune::getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) {
+    refresh();
+
+    // The filters aren't part of the sort, so they are read again even when nothing was sorted
+    for (Entry& entry: entries) {
+        entry.filter = entry.actor->getCollisionFilter();
+    }
+
+    const std::vector<float>& sortedMins = axis == 0 ? sortedBounds.minX : axis == 1 ? sortedBounds.minY : sortedBounds.minZ;
+
+    size_t candidates = 0;
+    std::vector<uint32_t> overlapping;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        if (entry.filter.layers == 0) continue;
+
+        // Every entry after this one that starts before this one ends overlaps it along the sort axis
+        size_t end = std::upper_bound(sortedMins.begin() + static_cast<std::ptrdiff_t>(i + 1), sortedMins.end(),
+                                      entry.bounds.max[axis]) - sortedMins.begin();
+        candidates += end - i - 1;
+
+        overlapping.clear();
+        sortedBounds.getOverlapping(entry.bounds, i + 1, end, overlapping);
+        for (uint32_t j: overlapping) {
+            if (entry.filter.canCollideWith(entries[j].filter)) outPairs.emplace_back(entry.actor, entries[j].actor);
+        }
+    }
+    return candidates;
+}
+
+void SweepAndPrune::getAllActors(std::vector<Actor*>& outVector) {
+    for (const Entry& entry: entries) {
+        outVector.push_back(entry.actor);
+    }
+}
+
+void SweepAndPrune::clear() {
+    entries.clear();
+    sortedCount = 0;
+    sortedBounds.clear();
+    actors.clear();
+    dirty = false;
+}
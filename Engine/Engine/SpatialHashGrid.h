@@ -0,0 +1,111 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+#include "RebuiltBroadPhase.h"
+#include "BoundingBox.h"
+#include "BoundingBoxList.h"
+#include "Collision/Collider.h"
+
+/**
+ * A broad phase that splits space into a uniform grid of cubes, only storing the cells that actors are in
+ * The grid is rebuilt from scratch whenever anything has moved, with a counting sort of the actors into their cells,
+ * so it suits crowds of many similarly sized actors that all move every frame. The cells should be about the size of
+ * the actors, actors that cover too many cells are kept aside and tested against everything.
+ */
+class SpatialHashGrid : public RebuiltBroadPhase {
+    /** Actors covering more cells than this are tested against every actor instead of being put in the cells */
+    size_t MAX_CELLS_PER_ACTOR = 64;
+    /** The number of cells, or actors, each thread takes at a time */
+    static constexpr size_t CELLS_PER_CHUNK = 256;
+
+    struct Cell {
+        int32_t x, y, z;
+        /** The index of the cell's first actor in cellActors */
+        uint32_t start;
+        /** The number of actors in the cell, 0 for empty slots */
+        uint32_t count;
+    };
+
+    /** The cells that an actor's bounding box covers, from minimum to maximum inclusive */
+    struct CellRange {
+        glm::ivec3 min, max;
+        /** The index of the actor's first cell in cellEntries */
+        size_t firstEntry;
+        /** The number of cells the actor is in, 0 if it covers too many */
+        size_t entryCount;
+    };
+
+    float cellSize;
+    float inverseCellSize;
+
+    /** The world bounding box of each actor when the grid was last rebuilt, in the same order as actors */
+    std::vector<BoundingBox> bounds;
+    /** Which actors each actor can be paired with */
+    std::vector<CollisionFilter> filters;
+    std::vector<CellRange> cellRanges;
+    /** The actors covering too many cells to be put in them */
+    std::vector<uint32_t> oversizedActors;
+    /** The same bounds as bounds, only filled in when there are oversized actors to test against them */
+    BoundingBoxList allBounds;
+    /** The actors found overlapping an oversized actor */
+    std::vector<uint32_t> overlapping;
+
+    /** The cell of each actor's bounding box in each cell it covers, grouped by actor */
+    std::vector<glm::ivec3> cellEntries;
+    /** The slot in cells of each of cellEntries */
+    std::vector<uint32_t> entrySlots;
+
+    /** A hash table of the cells the actors are in, found by linear probing from the hash of their coordinates */
+    std::vector<Cell> cells;
+    /** The number of bits of the hash used to index cells, which has a power of 2 size */
+    uint32_t cellBits = 0;
+    /** The slots of cells that are in use */
+    std::vector<uint32_t> usedSlots;
+    /** The actors in each cell, each cell's actors are together and in the order they are in actors */
+    std::vector<uint32_t> cellActors;
+    /** The bounds of each of cellActors, so the actors in a cell can be tested without looking them up */
+    std::vector<BoundingBox> cellBounds;
+
+    /**
+     * Get the cell a point is in
+     * @param point The world space point
+     * @return The coordinates of the cell
+     */
+    [[nodiscard]] glm::ivec3 getCell(const glm::vec3& point) const;
+
+    /**
+     * Find the slot in cells that a cell is in, or would be put in
+     * @param cell The coordinates of the cell
+     * @return The index of the slot
+     */
+    [[nodiscard]] uint32_t findSlot(const glm::ivec3& cell) const;
+
+    /**
+     * Sort the actors into their cells again, if anything has changed
+     */
+    void rebuild();
+
+public:
+    /**
+     * @param cellSize The length of the sides of the cells, about the size of the actors works best
+     * @param threadPool The thread pool to rebuild the grid and find pairs with, or nullptr to do it all on the calling
+     * thread. Must outlive the grid.
+     */
+    explicit SpatialHashGrid(float cellSize = 1.f, ThreadPool* threadPool = nullptr);
+
+    /** @inherit */
+    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) override;
+
+    /** @inherit */
+    void clear() override;
+};
@@ -0,0 +1,76 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "BoundingBox.h"
+#include "FlatBVH.h"
+#include "Scene/Actor/Actor.h"
+
+/**
+ * A bounding volume hierarchy of actors that never move, built once and never changed
+ * The hierarchy is a FlatBVH, so it can be saved and loaded as a single block of memory. Each leaf is a range of the
+ * tree's actors.
+ */
+class StaticAABBTree {
+    /** Nodes with this many actors or fewer aren't split */
+    static constexpr uint32_t MAX_LEAF_ACTORS = 4;
+
+    /** The hierarchy over actors */
+    FlatBVH hierarchy{MAX_LEAF_ACTORS};
+    /** The actors, with the actors of each leaf together */
+    std::vector<Actor*> actors;
+    /** The index of each of actors in the list the tree was built from, which is what gets saved */
+    std::vector<uint32_t> actorIndices;
+
+public:
+    /**
+     * Build the tree from scratch
+     * @param staticActors The actors to put in the tree, their world bounding boxes must be up to date
+     */
+    void build(const std::vector<Actor*>& staticActors);
+
+    /**
+     * Save the tree to a file, which refers to the actors by their index in the list the tree was built from
+     * @param filePath The path to the file
+     * @return true if the file was written
+     */
+    bool saveToFile(const std::string& filePath) const;
+
+    /**
+     * Load a tree from a file, instead of building it
+     * The bounds are recalculated from where the actors are now, so only the shape of the tree comes from the file
+     * @param filePath The path to the file
+     * @param staticActors The same actors, in the same order, as the tree was built from
+     * @return true if the tree was loaded, otherwise the tree is left empty
+     */
+    bool loadFromFile(const std::string& filePath, const std::vector<Actor*>& staticActors);
+
+    /**
+     * Find the actors whose bounding boxes overlap the given bounding box
+     * @param bb The world space bounding box
+     * @param function Called with each actor found
+     * @return The number of actors whose bounding boxes were tested
+     */
+    template<typename Function>
+    size_t query(const BoundingBox& bb, Function&& function) const;
+
+    /**
+     * Remove every actor from the tree
+     */
+    void clear();
+
+    [[nodiscard]] bool empty() const { return actors.empty(); }
+};
+
+template<typename Function>
+size_t StaticAABBTree::query(const BoundingBox& bb, Function&& function) const {
+    return hierarchy.query(bb, [&](uint32_t index) {
+        if (actors[index]->getWorldBoundingBox().overlaps(bb)) function(actors[index]);
+    });
+}
@@ -0,0 +1,98 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+
+#include "BroadPhase.h"
+#include "BoundingBox.h"
+#include "BoundingBoxList.h"
+#include "Collision/Collider.h"
+
+/**
+ * A broad phase that keeps the actors sorted by the start of their bounding boxes along one axis, then sweeps along
+ * that axis to find the overlapping pairs
+ * Actors that move slowly barely change order between frames, so the sort is an insertion sort that is close to
+ * linear on the nearly sorted actors. Suits scenes that are spread out along an axis, like crowds on a flat floor.
+ */
+class SweepAndPrune : public BroadPhase {
+    /** How much more spread out the actors have to be along another axis before the sort axis changes to it */
+    float AXIS_SWITCH_RATIO = 1.5f;
+
+    struct Entry {
+        /** The world bounding box of the actor when the entries were last sorted */
+        BoundingBox bounds;
+        Actor* actor;
+        /** Which actors the actor can be paired with, read again every time pairs are found */
+        CollisionFilter filter;
+    };
+
+    /** The actors, sorted by the minimum of their bounds along the sort axis */
+    std::vector<Entry> entries;
+    /** The number of entries at the start of entries that were there when they were last sorted, the rest are new */
+    size_t sortedCount = 0;
+    /** The bounds of the entries in the same order, so the sweep can test many of them at once */
+    BoundingBoxList sortedBounds;
+    /** The actors in entries, so updates can tell if an actor still needs inserting */
+    std::unordered_set<Actor*> actors;
+
+    /** The axis the entries are sorted along */
+    int axis;
+    /** If the sort axis follows the axis the actors are most spread out along */
+    bool chooseAxis;
+    /** The longest any actor's bounds are along the sort axis, so searches know how far back to look */
+    float maxExtent = 0;
+    /** If any actor has been inserted or moved since the entries were last sorted */
+    bool dirty = false;
+
+    /**
+     * Copy the actors' bounding boxes into the entries and sort them again, if anything has changed
+     */
+    void refresh();
+
+    /**
+     * Sort the entries along the sort axis, which the entries are already nearly sorted along unless it has changed
+     * @param newAxis The axis to sort along
+     */
+    void sortEntries(int newAxis);
+
+    /**
+     * Pick the axis the centres of the actors are most spread out along
+     * @return The axis to sort along
+     */
+    [[nodiscard]] int getWidestAxis() const;
+
+public:
+    /**
+     * @param axis The axis to sort along, 0 for x, 1 for y, 2 for z, or -1 to pick the axis the actors are most spread
+     * out along every time they are sorted
+     */
+    explicit SweepAndPrune(int axis = -1);
+
+    /** @inherit */
+    void insertActor(Actor* actor) override;
+
+    /** @inherit */
+    bool removeActor(Actor* actor) override;
+
+    /**
+     * The actors are only sorted again when they are next needed, so this only marks the entries out of date
+     * @inherit
+     */
+    bool updateActor(Actor* actor) override;
+
+    /** @inherit */
+    void getCloseActors(Actor* actor, std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    size_t getAllPotentialPairs(std::vector<std::pair<Actor*, Actor*>>& outPairs) override;
+
+    /** @inherit */
+    void getAllActors(std::vector<Actor*>& outVector) override;
+
+    /** @inherit */
+    void clear() override;
+};
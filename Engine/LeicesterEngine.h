@@ -10,9 +10,22 @@ protected:
     Renderer* renderer = nullptr;
     CollisionEngine* collisionEngine = nullptr;
     double lastFrameTime = 0, frameDelta = 0;
+
+    /** The potentially colliding pairs found this frame, kept to reuse the allocation between frames */
+    std::vector<std::pair<Actor*, Actor*>> collisionPairs;
+    /** The result of testing each of collisionPairs, at the same index as the pair */
+    std::vector<CollisionResult> collisionResults;
+    /** The pairs that collided when they were last tested, kept while both actors are asleep as they aren't tested again */
+    std::vector<std::pair<Actor*, Actor*>> restingCollisions;
 public:
     EngineSettings settings;
 
+protected:
+    /** The threads collision tests are split between, after settings so it can be sized from them */
+    ThreadPool collisionThreadPool{settings.collisionThreads};
+
+public:
+
     Scene* currentScene = nullptr;
 
     virtual int initialise();
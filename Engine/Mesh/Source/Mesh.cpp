@@ -64,7 +64,7 @@ BoundingBox Mesh::calculateBoundingBox() const {
         if (vertex.position.y > maxY) maxY = vertex.position.y;
         else if (vertex.position.y < minY) minY = vertex.position.y;
         if (vertex.position.z > maxZ) maxZ = vertex.position.z;
-        else if (vertex.position.z > minZ) minZ = vertex.position.z;
+        else if (vertex.position.z < minZ) minZ = vertex.position.z;
 
     }
     return {
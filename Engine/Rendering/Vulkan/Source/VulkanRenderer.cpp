@@ -6,6 +6,7 @@
 #include "../MeshPushConstants.h"
 #include <Utils/Logger.h>
 #include <Utils/FileUtils.h>
+#include <Collision/CompoundCollider.h>
 
 #include <VkBootstrap.h>
 #include <glm/ext/matrix_transform.hpp>
@@ -1024,12 +1025,22 @@ void VulkanRenderer::cleanup() {
 
 void VulkanRenderer::drawFrame(const double deltaTime, const double gameTime, const Scene& scene) {
     std::vector<const Actor*> toRender;
-    std::vector<const Actor*> toRenderCollision;
+    std::vector<Collider*> toRenderCollision;
+    // Whether the actor of each of toRenderCollision is colliding
+    std::vector<bool> toRenderColliding;
     // Calculate actors to render
     {
         for (const Actor* actor : scene.actors) {
             if (actor->hasMesh()) toRender.push_back(actor);
-            if (actor->hasCollision()) toRenderCollision.push_back(actor);
+            if (actor->hasCollision()) {
+                // Compound colliders have no mesh, so each collider in them is drawn instead
+                if (actor->actorCollider->colliderType == ColliderType::COMPOUND) {
+                    static_cast<const CompoundCollider*>(actor->actorCollider)->getLeafColliders(toRenderCollision);
+                } else {
+                    toRenderCollision.push_back(actor->actorCollider);
+                }
+                toRenderColliding.resize(toRenderCollision.size(), actor->actorCollider->isColliding);
+            }
         }
     }
 
@@ -1131,9 +1142,7 @@ void VulkanRenderer::drawFrame(const double deltaTime, const double gameTime, co
             }
 
             for (int i = 0; i < toRenderCollision.size(); ++i) {
-                const Actor* actor = toRenderCollision[i];
-
-                glm::mat4 model = actor->actorCollider->getRenderMeshTransform();
+                glm::mat4 model = toRenderCollision[i]->getRenderMeshTransform();
                 objectSSBO[i + toRender.size()].modelMatrix = model;
             }
 
@@ -1180,8 +1189,7 @@ void VulkanRenderer::drawFrame(const double deltaTime, const double gameTime, co
                                 2, 1, &vMat.materialDescriptor, 0, nullptr);
 
         for (int i = 0; i < toRenderCollision.size(); ++i) {
-            const Actor* actor = toRenderCollision[i];
-            Mesh* mesh = actor->actorCollider->getRenderMesh();
+            Mesh* mesh = toRenderCollision[i]->getRenderMesh();
 
             AllocatedBuffer vertBuffer = this->bufferList.get(mesh->verticesId);
             AllocatedBuffer indBuffer = this->bufferList.get(mesh->indicesId);
@@ -1192,7 +1200,7 @@ void VulkanRenderer::drawFrame(const double deltaTime, const double gameTime, co
 
             MeshPushConstants pushConstants = {
                     {},
-                    actor->actorCollider->isColliding
+                    toRenderColliding[i]
                         ? glm::vec4(0.f, 1.f, 0.f, 1.f)
                         : glm::vec4(1.f, 0.f, 0.f, 1.f)
             };
@@ -1817,7 +1825,15 @@ void VulkanRenderer::setupScene(Scene& scene) {
         if (actor->hasCollision()) {
             // Upload collision mesh
             // TODO: Add flag for this
-            registerMesh(actor->actorCollider->getRenderMesh());
+            if (actor->actorCollider->colliderType == ColliderType::COMPOUND) {
+                std::vector<Collider*> colliders;
+                static_cast<const CompoundCollider*>(actor->actorCollider)->getLeafColliders(colliders);
+                for (Collider* collider : colliders) {
+                    registerMesh(collider->getRenderMesh());
+                }
+            } else {
+                registerMesh(actor->actorCollider->getRenderMesh());
+            }
         }
     }
 }
@@ -11,6 +11,7 @@
 #include "Engine/LObject.h"
 
 struct Scene;
+class Octree;
 
 struct Actor : public LObject {
 
@@ -20,6 +21,27 @@ struct Actor : public LObject {
 
     Scene* scene = nullptr;
 
+    /** The octree node the actor is currently stored in, maintained by the Octree */
+    Octree* octreeNode = nullptr;
+    /** The index of the actor in the entities of octreeNode, maintained by the Octree */
+    size_t octreeIndex = 0;
+    /** How the broad phase the actor is stored in finds it, like its leaf in a DynamicAABBTree, maintained by the broad phase */
+    int32_t broadPhaseProxy = -1;
+
+    /**
+     * If the actor never moves, static actors are kept in the scene's static tree instead of the broad phase
+     * Must be set before the actor is added to the scene
+     */
+    bool isStatic = false;
+
+    /** The number of frames in a row the actor hasn't moved, maintained by the scene */
+    uint32_t framesAtRest = 0;
+    /** Pairs of sleeping actors aren't tested for collision, set by the scene once the actor has been at rest for long enough */
+    bool asleep = false;
+
+    /** The bounding box of the actor's collider in world space, as of the last updateWorldBoundingBox */
+    BoundingBox worldBoundingBox{glm::vec3(0), glm::vec3(0)};
+
     Actor(StaticMesh *mesh, Collider *collider);
     Actor(StaticMesh* mesh, Collider* collider, const glm::vec3& position, const glm::vec3& scale,
           const glm::vec3& rotation);
@@ -36,8 +58,26 @@ struct Actor : public LObject {
 
     [[nodiscard]] bool hasMesh() const;
 
+    /**
+     * Get the filter the broad phase uses to decide which actors this can be paired with
+     * @return The collider's filter, or a filter on no layers if the actor has no collider or its collision mode is NONE
+     */
+    [[nodiscard]] CollisionFilter getCollisionFilter() const;
+
     [[nodiscard]] BoundingBox getBoundingBox() const;
 
+    /**
+     * Get the bounding box of the actor's collider, offset by the actor's position
+     * This is cached, and only recalculated by updateWorldBoundingBox, which the scene calls every tick
+     * @return The bounding box in world space
+     */
+    [[nodiscard]] const BoundingBox& getWorldBoundingBox() const;
+
+    /**
+     * Recalculate the cached world space bounding box of the actor's collider
+     */
+    void updateWorldBoundingBox();
+
     virtual void handleInput(int key, int scancode, int action, int mods);
 
     virtual void handleMouse(double mouseX, double mouseY);
@@ -45,12 +45,27 @@ bool Actor::hasMesh() const {
     return this->actorMesh != nullptr;
 }
 
+CollisionFilter Actor::getCollisionFilter() const {
+    if (!hasCollision() || actorCollider->collisionMode == CollisionMode::NONE) return {0, 0};
+    return actorCollider->collisionFilter;
+}
+
 BoundingBox Actor::getBoundingBox() const {
     if (!hasCollision()) return {glm::vec3(0), glm::vec3(0)};
 
     return actorCollider->getBoundingBox();
 }
 
+const BoundingBox& Actor::getWorldBoundingBox() const {
+    return worldBoundingBox;
+}
+
+void Actor::updateWorldBoundingBox() {
+    BoundingBox bb = getBoundingBox();
+    glm::vec3 position = getPosition();
+    worldBoundingBox = {bb.min + position, bb.max + position};
+}
+
 void Actor::handleInput(int key, int scancode, int action, int mods) {}
 
 void Actor::handleMouse(double mouseX, double mouseY) {}
@@ -5,15 +5,27 @@
 #pragma once
 
 #include <vector>
+#include <string>
 
 #include "Engine/Octree.h"
+#include "Engine/StaticAABBTree.h"
 
 struct Actor;
 
 struct Scene : public LObject {
+    /** Actors that haven't moved for this many frames go to sleep */
+    uint32_t FRAMES_UNTIL_SLEEP = 60;
+
     std::vector<Actor*> actors;
     Actor* controlledActor;
-    Octree* octree = new Octree(glm::vec3(100), glm::vec3(0));
+    /** Finds the actors that may be colliding, owned by the scene, only has the actors that aren't static */
+    BroadPhase* broadPhase = new Octree(glm::vec3(100), glm::vec3(0));
+    /** The static actors, in the order they were added */
+    std::vector<Actor*> staticActors;
+    /** Finds the static actors that may be colliding with an actor, see bakeStaticActors */
+    StaticAABBTree staticTree;
+    /** If static actors have been added since the static tree was last built */
+    bool staticTreeDirty = false;
 
     void onCreate() override;
 
@@ -31,6 +43,34 @@ struct Scene : public LObject {
 
     void setControlledActor(Actor* actor);
 
+    /**
+     * Replace the broad phase, moving every actor into the new one
+     * The old broad phase is deleted
+     * @param newBroadPhase The broad phase to use, the scene takes ownership of it
+     */
+    void setBroadPhase(BroadPhase* newBroadPhase);
+
+    /**
+     * Build the static tree from the static actors, if any have been added since it was last built
+     * This is done when the collision engine next needs it, but can be called up front to keep it out of the first frame
+     */
+    void bakeStaticActors();
+
+    /**
+     * Save the static tree, so it can be loaded instead of built next time
+     * @param filePath The path to the file
+     * @return true if the file was written
+     */
+    bool saveStaticActors(const std::string& filePath);
+
+    /**
+     * Load the static tree from a file saved by saveStaticActors
+     * The same static actors must have been added to the scene in the same order as when it was saved
+     * @param filePath The path to the file
+     * @return true if the tree was loaded, otherwise it will be built as normal
+     */
+    bool loadStaticActors(const std::string& filePath);
+
     void handleInputs(int key, int scancode, int action, int mods);
 
     void handleMouse(double mouseX, double mouseY);
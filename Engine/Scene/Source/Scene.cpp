@@ -13,13 +13,27 @@ void Scene::onCreate() {
 }
 
 void Scene::tick(double deltaTime) {
-    octree->clearTree();
+    for (auto& actor : actors) {
+        actor->tick(deltaTime);
+    }
+
+    // Static actors never move, and neither do ones that haven't been moved, so only the rest need updating
     for (Actor* actor: actors) {
-        octree->insertNode(actor);
+        if (actor->isStatic) continue;
+        if (!actor->hasMoved()) {
+            if (++actor->framesAtRest >= FRAMES_UNTIL_SLEEP) actor->asleep = true;
+            continue;
+        }
+
+        actor->framesAtRest = 0;
+        actor->asleep = false;
+        actor->updateWorldBoundingBox();
+        broadPhase->updateActor(actor);
     }
 
-    for (auto& actor : actors) {
-        actor->tick(deltaTime);
+    // Cleared afterwards, as an actor that moved its children needs them to see it moved
+    for (Actor* actor: actors) {
+        actor->clearMoved();
     }
 }
 
@@ -32,7 +46,15 @@ void Scene::onDestroy() {
 
 void Scene::addActorToScene(Actor* actor) {
     this->actors.push_back(actor);
-    this->octree->insertNode(actor);
+    actor->updateWorldBoundingBox();
+    if (actor->isStatic) {
+        // Static actors never move, so sleep from the start
+        actor->asleep = true;
+        this->staticActors.push_back(actor);
+        this->staticTreeDirty = true;
+    } else {
+        this->broadPhase->insertActor(actor);
+    }
     actor->scene = this;
     actor->onCreate();
 }
@@ -41,6 +63,38 @@ void Scene::setControlledActor(Actor* actor) {
     this->controlledActor = actor;
 }
 
+void Scene::setBroadPhase(BroadPhase* newBroadPhase) {
+    broadPhase->clear();
+    delete broadPhase;
+
+    broadPhase = newBroadPhase;
+    for (Actor* actor: actors) {
+        if (actor->isStatic) continue;
+        actor->updateWorldBoundingBox();
+        broadPhase->insertActor(actor);
+    }
+}
+
+void Scene::bakeStaticActors() {
+    if (!staticTreeDirty) return;
+    staticTree.build(staticActors);
+    staticTreeDirty = false;
+}
+
+bool Scene::saveStaticActors(const std::string& filePath) {
+    bakeStaticActors();
+    return staticTree.saveToFile(filePath);
+}
+
+bool Scene::loadStaticActors(const std::string& filePath) {
+    if (!staticTree.loadFromFile(filePath, staticActors)) {
+        staticTreeDirty = true;
+        return false;
+    }
+    staticTreeDirty = false;
+    return true;
+}
+
 void Scene::handleInputs(int key, int scancode, int action, int mods) {
     if (controlledActor != nullptr) {
         controlledActor->handleInput(key, scancode, action, mods);
@@ -4,6 +4,7 @@
 #include "../LeicesterEngine.h"
 #include "Utils/Logger.h"
 #include <glm/gtx/string_cast.hpp>
+#include <algorithm>
 
 int LeicesterEngine::initialise() {
     // Initialise GLFW
@@ -75,24 +76,43 @@ int LeicesterEngine::startLoop() {
 
         // Check for collision
         for (const auto& actor : currentScene->actors) {
-            if (!actor->hasCollision()) continue;
-            std::vector<Actor*> potentialCollisions;
-            if (!collisionEngine->getNearbyColliders(actor, potentialCollisions)) continue;
-
-            bool anyCollisions = false;
-            for (const auto& otherActor: potentialCollisions) {
-                if (!otherActor->hasCollision() || otherActor == actor) continue;
-                CollisionResult result = collisionEngine->testCollision(actor, otherActor);
-                if (actor != currentScene->controlledActor && result.collided && actor->actorCollider->collisionMode == CollisionMode::BLOCK && otherActor->actorCollider->collisionMode == CollisionMode::BLOCK) {
-                    Logger::info("Normal: " + glm::to_string(result.normal) + ", Distance: " + std::to_string(result.depth));
-
-                    // Un-collide
+            if (actor->hasCollision()) actor->actorCollider->isColliding = false;
+        }
+
+        // Pairs that are asleep aren't tested, but haven't moved since they last collided, so are still colliding
+        restingCollisions.erase(std::remove_if(restingCollisions.begin(), restingCollisions.end(), [](const auto& pair) {
+            return !pair.first->asleep || !pair.second->asleep;
+        }), restingCollisions.end());
+        for (const auto& [actor, otherActor] : restingCollisions) {
+            actor->actorCollider->isColliding = true;
+            otherActor->actorCollider->isColliding = true;
+        }
+
+        // Find and test every pair before moving anything, so the results don't depend on which thread tests a pair
+        collisionPairs.clear();
+        collisionEngine->getPotentialCollisionPairs(collisionPairs);
+        collisionEngine->testCollisions(collisionPairs, collisionResults, collisionThreadPool);
+
+        // Resolve in pair order, so the actors end up in the same place every time
+        for (size_t i = 0; i < collisionPairs.size(); ++i) {
+            const auto& [actor, otherActor] = collisionPairs[i];
+            const CollisionResult& result = collisionResults[i];
+            if (!result.collided) continue;
+
+            if (actor->actorCollider->collisionMode == CollisionMode::BLOCK && otherActor->actorCollider->collisionMode == CollisionMode::BLOCK) {
+                Logger::info("Normal: " + glm::to_string(result.normal) + ", Distance: " + std::to_string(result.depth));
+
+                // Un-collide, the normal is from the first actor's perspective so is flipped for the second
+                if (actor != currentScene->controlledActor) {
                     actor->setLocalPosition(actor->getPosition() + (result.normal * -result.depth));
+                } else if (otherActor != currentScene->controlledActor) {
+                    otherActor->setLocalPosition(otherActor->getPosition() + (result.normal * result.depth));
                 }
-                anyCollisions |= result.collided;
             }
 
-            actor->actorCollider->isColliding = anyCollisions;
+            actor->actorCollider->isColliding = true;
+            otherActor->actorCollider->isColliding = true;
+            restingCollisions.push_back(collisionPairs[i]);
         }
 
         // Render Frame
@@ -111,6 +131,7 @@ void LeicesterEngine::setScene(Scene* scene) {
     }
 
     currentScene = scene;
+    restingCollisions.clear();
     collisionEngine->scene = this->currentScene;
     currentScene->onCreate();
 }
@@ -0,0 +1,46 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * An allocator for standard containers that aligns the storage, for data that is loaded with aligned SIMD instructions
+ * @tparam T The type being allocated
+ * @tparam Alignment The alignment in bytes
+ */
+template<typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const {
+        return false;
+    }
+};
@@ -15,4 +15,8 @@ struct EngineSettings {
     const unsigned int bufferCount = 2;
 
     const std::string windowTitle = "Leicester Engine";
+
+    // Collision
+    /** The number of threads collision tests are split between, 0 uses one for every hardware thread */
+    const unsigned int collisionThreads = 0;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#include "Utils/ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // The calling thread is one of the threads
+    workers.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+
+    for (std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::runChunks() {
+    while (true) {
+        size_t begin = nextIndex.fetch_add(taskChunkSize, std::memory_order_relaxed);
+        if (begin >= taskCount) return;
+
+        (*task)(begin, std::min(begin + taskChunkSize, taskCount));
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t lastGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [&] { return stopping || generation != lastGeneration; });
+            if (stopping) return;
+            lastGeneration = generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        workDone.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t, size_t)>& function) {
+    if (count == 0) return;
+    chunkSize = std::max<size_t>(chunkSize, 1);
+
+    // Not worth waking the workers for a single chunk
+    if (workers.empty() || count <= chunkSize) {
+        function(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &function;
+        taskCount = count;
+        taskChunkSize = chunkSize;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        ++generation;
+    }
+    workReady.notify_all();
+
+    runChunks();
+
+    // Every worker has to check in, even ones that found no chunks left, so none of them miss the next loop
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [&] { return busyWorkers == 0; });
+    task = nullptr;
+}
@@ -0,0 +1,74 @@
+//
+// Created by jacob on 17/10/26.
+//
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+/**
+ * A fixed set of worker threads that split loops between them
+ * The thread calling parallelFor works on the loop too, so a pool of 1 thread runs everything on the calling thread
+ */
+class ThreadPool {
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+
+    /** The loop being run, only valid while a parallelFor is running */
+    const std::function<void(size_t begin, size_t end)>* task = nullptr;
+    size_t taskCount = 0;
+    size_t taskChunkSize = 1;
+    /** The start of the next chunk of the loop to be taken by a thread */
+    std::atomic<size_t> nextIndex{0};
+
+    /** Incremented for each loop, so the workers know there is a new one */
+    uint64_t generation = 0;
+    /** The number of workers that haven't finished the current loop */
+    size_t busyWorkers = 0;
+    bool stopping = false;
+
+    /**
+     * Take chunks of the current loop and run them until there are none left
+     */
+    void runChunks();
+
+    /**
+     * The function run by each worker thread
+     */
+    void workerLoop();
+public:
+    /**
+     * @param threadCount The number of threads to split loops between, including the calling thread, 0 uses one for
+     * every hardware thread
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * Get the number of threads loops are split between, including the calling thread
+     * @return The number of threads
+     */
+    [[nodiscard]] size_t getThreadCount() const;
+
+    /**
+     * Run a loop split into chunks across the threads of the pool, returning once every chunk has finished
+     * Chunks are taken by whichever thread is free, so the function must be safe to run on different chunks at once
+     * @param count The number of iterations in the loop
+     * @param chunkSize The number of iterations each thread takes at a time
+     * @param function The function to run on each chunk, given the first iteration and one past the last
+     */
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& function);
+};
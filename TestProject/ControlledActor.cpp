@@ -10,12 +10,14 @@
 
 void ControlledActor::handleInput(int key, int scancode, int action, int mods) {
     if (action != GLFW_PRESS) return;
-    if (key == GLFW_KEY_W) position.z -= .5f;
-    else if (key == GLFW_KEY_S) position.z += .5f;
-    if (key == GLFW_KEY_A) position.x -= .5f;
-    else if (key == GLFW_KEY_D) position.x += .5f;
-    if (key == GLFW_KEY_SPACE) position.y -= .5f;
-    else if (key == GLFW_KEY_LEFT_CONTROL) position.y += .5f;
+    glm::vec3 movement(0);
+    if (key == GLFW_KEY_W) movement.z -= .5f;
+    else if (key == GLFW_KEY_S) movement.z += .5f;
+    if (key == GLFW_KEY_A) movement.x -= .5f;
+    else if (key == GLFW_KEY_D) movement.x += .5f;
+    if (key == GLFW_KEY_SPACE) movement.y -= .5f;
+    else if (key == GLFW_KEY_LEFT_CONTROL) movement.y += .5f;
+    setLocalPosition(position + movement);
 }
 
 void ControlledActor::handleMouse(double mouseX, double mouseY) {
@@ -24,7 +26,7 @@ void ControlledActor::handleMouse(double mouseX, double mouseY) {
     lastMouseX = mouseX;
     lastMouseY = mouseY;
 
-    rotation += glm::vec3(deltaY * .01, 0, deltaX * -.01);
+    setLocalRotation(rotation + glm::vec3(deltaY * .01, 0, deltaX * -.01));
 }
 
 
@@ -10,7 +10,12 @@
 #include "Collision/GJKCollisionEngine.h"
 #include "Collision/AABBCollider.h"
 #include "Collision/MeshCollider.h"
+#include "Collision/OBBCollider.h"
+#include "Collision/CompoundCollider.h"
+#include "Collision/TriangleMeshCollider.h"
+#include "Collision/HeightfieldCollider.h"
 #include "RockingActor.h"
+#include <cmath>
 
 Scene *pbrTest();
 
@@ -57,6 +62,40 @@ Scene* collisionScene() {
     collisionObject8->setLocalPosition(glm::vec3(-3, -3, -3));
     scene->addActorToScene(collisionObject8);
 
+    // A table, its top and legs are each a box in one compound collider
+    CompoundCollider* table = new CompoundCollider(CollisionMode::BLOCK);
+    table->addChild(new OBBCollider(CollisionMode::BLOCK, {-1, -0.1, -0.6}, {1, 0.1, 0.6}));
+    for (float x : {-0.9f, 0.9f}) {
+        for (float z : {-0.5f, 0.5f}) {
+            OBBCollider* leg = new OBBCollider(CollisionMode::BLOCK, {-0.05, -0.4, -0.05}, {0.05, 0.4, 0.05});
+            leg->setLocalPosition(glm::vec3(x, -0.5, z));
+            table->addChild(leg);
+        }
+    }
+    Actor* collisionObject9 = new Actor(nullptr, table);
+    collisionObject9->setLocalPosition(glm::vec3(0, -3, 0));
+    collisionObject9->setLocalRotation(glm::vec3(0, 0.5, 0));
+    scene->addActorToScene(collisionObject9);
+
+    // Level geometry, collided with triangle by triangle so the gaps around the ears and eyes can be moved into
+    Actor* collisionObject10 = new Actor(nullptr, new TriangleMeshCollider(CollisionMode::BLOCK, mesh));
+    collisionObject10->setLocalPosition(glm::vec3(0, 3, -3));
+    collisionObject10->setLocalScale(glm::vec3(1.5));
+    collisionObject10->isStatic = true;
+    scene->addActorToScene(collisionObject10);
+
+    // Rolling ground under everything, only the cells under a collider are tested against it
+    std::vector<float> heights;
+    for (uint32_t z = 0; z < 65; ++z) {
+        for (uint32_t x = 0; x < 65; ++x) {
+            heights.push_back(std::sin(static_cast<float>(x) * 0.3f) * 0.5f + std::cos(static_cast<float>(z) * 0.2f) * 0.5f);
+        }
+    }
+    Actor* collisionObject11 = new Actor(nullptr, new HeightfieldCollider(CollisionMode::BLOCK, 65, 65, 0.25f, heights));
+    collisionObject11->setLocalPosition(glm::vec3(-8, -6, -8));
+    collisionObject11->isStatic = true;
+    scene->addActorToScene(collisionObject11);
+
     Actor* monkey = new ControlledActor(new StaticMesh(mesh, triangleMaterial),
                                         new AABBCollider(CollisionMode::BLOCK, {-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5}));
     scene->addActorToScene(monkey);